@@ -0,0 +1,452 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <sys/resource.h>
+#endif
+
+// Include justparser
+#include <justparser>
+
+// Benchmark suite: synthetic corpora by sizes, throughput (MB/s), lookup latency, peak RSS and allocations
+// example, just-bench --sizes=1K,1M,64M --filter=deep --format=json > result.json
+
+#if defined(__GLIBC__)
+// count of the allocations (malloc, calloc, realloc), the library is counted also (symbols interposition)
+static std::atomic<long long> allocations(0);
+
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* block, std::size_t size);
+
+void* malloc(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* block, std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(block, size);
+}
+}
+
+long long allocation_count() { return allocations.load(std::memory_order_relaxed); }
+#else
+// allocations is not counted (-1)
+long long allocation_count() { return -1; }
+#endif
+
+// Reset peak of the resident memory (Linux: clear_refs), otherwise peak is for the process
+void reset_peak_rss()
+{
+    std::ofstream refs("/proc/self/clear_refs");
+    if (refs)
+        refs << "5";
+}
+
+// Peak of the resident memory (bytes), -1 is unknown
+long long peak_rss()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+        if (line.compare(0, 6, "VmHWM:") == 0)
+            return std::atoll(line.c_str() + 6) * 1024;
+#if defined(__GLIBC__)
+    struct rusage usage;
+    if (!getrusage(RUSAGE_SELF, &usage))
+        return static_cast<long long>(usage.ru_maxrss) * 1024;
+#endif
+    return -1;
+}
+
+// synthetic document, blocks "b<N>" on top-level (paths for lookup)
+struct corpus {
+    std::string name;
+    std::string source;
+    // valid path and search pattern
+    std::string path;
+    std::string pattern;
+    int blocks;
+};
+
+// records with the all types
+void make_mixed(std::string& source, int x)
+{
+    std::string id = std::to_string(x);
+    source += "b" + id + " {\n";
+    source += "    id " + id + "\n";
+    source += "    name \"name of the record " + id + "\"\n";
+    source += "    rate " + std::to_string(x % 1000) + "." + std::to_string(x % 7) + "\n";
+    source += "    active " + std::string(x % 2 ? "true" : "false") + "\n";
+    source += "    values { " + std::to_string(x) + ", " + std::to_string(x * 3) + ", " + std::to_string(x * 7) + " }\n";
+    source += "}\n";
+}
+
+// nested trees by 32 levels
+void make_deep(std::string& source, int x)
+{
+    const int depth = 32;
+    source += "b" + std::to_string(x) + " {";
+    for (int y = 1; y < depth; ++y)
+        source += " n" + std::to_string(y) + " {";
+    source += " leaf " + std::to_string(x);
+    source.append(depth, '}');
+    source += "\n";
+}
+
+// trees of the 256 properties
+void make_wide(std::string& source, int x)
+{
+    const int width = 256;
+    source += "b" + std::to_string(x) + " {\n";
+    for (int y = 0; y < width; ++y)
+        source += "  k" + std::to_string(y) + " " + std::to_string(x + y) + "\n";
+    source += "}\n";
+}
+
+// big arrays of numbers and reals
+void make_numeric(std::string& source, int x)
+{
+    const int elements = 1024;
+    source += "b" + std::to_string(x) + " {\n  ints {";
+    for (int y = 0; y < elements; ++y)
+        source += (y ? ", " : " ") + std::to_string(x * elements + y);
+    source += " }\n  reals {";
+    for (int y = 0; y < elements; ++y)
+        source += (y ? ", " : " ") + std::to_string(y) + "." + std::to_string((x + y) % 1000);
+    source += " }\n}\n";
+}
+
+// long strings, with escape sequences and repeated values
+void make_strings(std::string& source, int x)
+{
+    std::string id = std::to_string(x);
+    source += "b" + id + " {\n";
+    source += "  title \"The quick brown fox jumps over the lazy dog, record " + id + "\"\n";
+    source += "  text \"Line one\\nLine two \\\"quoted\\\" \\t tab " + id + " Lorem ipsum dolor sit amet, consectetur adipiscing elit\"\n";
+    source += "  kind \"" + std::string(x % 3 ? "document" : "message") + "\"\n";
+    source += "  tags { \"red\", \"green\", \"blue\", \"tag" + std::to_string(x % 100) + "\" }\n";
+    source += "}\n";
+}
+
+// comments between properties
+void make_comments(std::string& source, int x)
+{
+    std::string id = std::to_string(x);
+    source += "// block " + id + ": comment line before the tree, it is skipped by parser\n";
+    source += "b" + id + " {\n";
+    source += "  // identifier of the block\n";
+    source += "  id " + id + " // comment after value\n";
+    source += "  // name of the block, comment with \"quotes\" and { braces }\n";
+    source += "  name \"block " + id + "\"\n";
+    source += "}\n";
+}
+
+// syntax.just of the tests, it is near the executable (see. CMakeLists.txt)
+std::string syntax_file = "syntax.just";
+
+// copies of syntax.just, each is a tree
+void make_syntax(std::string& source, int x)
+{
+    static std::string text;
+    if (text.empty()) {
+        std::ifstream file(syntax_file, std::ios::binary);
+        text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (text.empty())
+            throw std::runtime_error("error open file " + syntax_file);
+    }
+    source += "b" + std::to_string(x) + " {\n";
+    source += text;
+    source += "\n}\n";
+}
+
+corpus generate(const std::string& name, std::size_t size)
+{
+    static const struct {
+        const char* name;
+        void (*make)(std::string&, int);
+        const char* path;
+    } kinds[] = { { "mixed", make_mixed, "/name" }, { "deep", make_deep, "/n1/n2/n3/n4/n5/n6/n7/n8" }, { "wide", make_wide, "/k200" }, { "numeric", make_numeric, "/reals" }, { "strings", make_strings, "/kind" }, { "comments", make_comments, "/id" }, { "syntax", make_syntax, "/struct_tree/humans/human2/name" } };
+    corpus result;
+    for (const auto& kind : kinds) {
+        if (name != kind.name)
+            continue;
+        result.name = name;
+        result.source.reserve(size + 4096);
+        for (result.blocks = 0; result.blocks == 0 || result.source.size() < size; ++result.blocks)
+            kind.make(result.source, result.blocks);
+        result.path = kind.path;
+        result.pattern = "b" + std::to_string(result.blocks - 1);
+        return result;
+    }
+    throw std::invalid_argument("unknown corpus " + name);
+}
+
+// result of the one benchmark
+struct measure {
+    std::string name;
+    std::string corpus;
+    std::size_t bytes;
+    // best time of the repeats (ns)
+    double time;
+    // MB/s (throughput benchmarks)
+    double throughput;
+    // percentiles of the operations (latency benchmarks, ns)
+    double p50;
+    double p99;
+    long long allocations;
+    long long peakRss;
+};
+
+template <typename Function>
+double best_of(int repeats, Function function)
+{
+    double best = 1e100;
+    for (int x = 0; x < repeats; ++x) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (seconds < best)
+            best = seconds;
+    }
+    return best;
+}
+
+std::string size_name(std::size_t size)
+{
+    if (size >= (1 << 30) && size % (1 << 30) == 0)
+        return std::to_string(size >> 30) + "G";
+    if (size >= (1 << 20) && size % (1 << 20) == 0)
+        return std::to_string(size >> 20) + "M";
+    if (size >= (1 << 10) && size % (1 << 10) == 0)
+        return std::to_string(size >> 10) + "K";
+    return std::to_string(size);
+}
+
+std::size_t parse_size(const std::string& text)
+{
+    std::size_t size = std::stoull(text);
+    switch (text.empty() ? 0 : text.back()) {
+    case 'K':
+    case 'k':
+        return size << 10;
+    case 'M':
+    case 'm':
+        return size << 20;
+    case 'G':
+    case 'g':
+        return size << 30;
+    }
+    return size;
+}
+
+std::vector<std::string> split(const std::string& text)
+{
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    for (std::string part; std::getline(stream, part, ',');)
+        if (!part.empty())
+            parts.push_back(part);
+    return parts;
+}
+
+// Throughput benchmark: time, allocations and peak RSS of the one call, function returns processed bytes
+measure run_throughput(const std::string& name, const corpus& data, int repeats, const std::function<std::size_t()>& function)
+{
+    measure result = { name, data.name, 0, 0, 0, 0, 0, 0, 0 };
+    long long allocated;
+
+    reset_peak_rss();
+    allocated = allocation_count();
+    result.bytes = function();
+    result.allocations = allocated < 0 ? -1 : allocation_count() - allocated;
+    result.peakRss = peak_rss();
+
+    result.time = best_of(repeats, function) * 1e9;
+    result.throughput = result.bytes / 1e6 / (result.time / 1e9);
+    return result;
+}
+
+// Latency benchmark: every operation is timed, percentiles by operations
+measure run_latency(const std::string& name, const corpus& data, int operations, const std::function<void(int)>& function)
+{
+    measure result = { name, data.name, 0, 0, 0, 0, 0, 0, 0 };
+    std::vector<double> times(operations);
+    long long allocated = allocation_count();
+    double total = 0;
+
+    for (int x = 0; x < operations; ++x) {
+        auto start = std::chrono::steady_clock::now();
+        function(x);
+        times[x] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        total += times[x];
+    }
+    result.allocations = allocated < 0 ? -1 : allocation_count() - allocated;
+    result.peakRss = peak_rss();
+    std::sort(times.begin(), times.end());
+    result.time = total / operations;
+    result.p50 = times[operations / 2];
+    result.p99 = times[std::min(operations - 1, operations * 99 / 100)];
+    return result;
+}
+
+void print_console(const measure& result)
+{
+    std::cout << std::left << std::setw(36) << result.name << std::right << std::fixed << std::setprecision(1);
+    if (result.bytes)
+        std::cout << std::setw(12) << result.time / 1e6 << " ms" << std::setw(10) << result.throughput << " MB/s";
+    else
+        std::cout << std::setw(12) << result.time << " ns" << std::setw(10) << result.p99 << " p99 ";
+    std::cout << std::setw(10) << result.allocations << " allocs" << std::setw(8) << result.peakRss / (1 << 20) << " MB rss" << std::endl;
+}
+
+void print_json(std::ostream& out, const std::vector<measure>& results, int repeats)
+{
+    std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    out << "{\n  \"context\": {\n";
+    out << "    \"date\": \"" << date << "\",\n";
+    out << "    \"library\": \"just-parser\",\n";
+    out << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+    out << "    \"repeats\": " << repeats << ",\n";
+    out << "    \"allocations_counted\": " << (allocation_count() >= 0 ? "true" : "false") << "\n";
+    out << "  },\n  \"benchmarks\": [";
+    for (std::size_t x = 0; x < results.size(); ++x) {
+        const measure& result = results[x];
+        out << (x ? ",\n" : "\n") << "    {\n";
+        out << "      \"name\": \"" << result.name << "\",\n";
+        out << "      \"corpus\": \"" << result.corpus << "\",\n";
+        if (result.bytes) {
+            out << "      \"bytes\": " << result.bytes << ",\n";
+            out << "      \"real_time_ns\": " << std::fixed << std::setprecision(0) << result.time << ",\n";
+            out << "      \"mb_per_second\": " << std::setprecision(2) << result.throughput << ",\n";
+        } else {
+            out << "      \"mean_ns\": " << std::fixed << std::setprecision(1) << result.time << ",\n";
+            out << "      \"p50_ns\": " << result.p50 << ",\n";
+            out << "      \"p99_ns\": " << result.p99 << ",\n";
+        }
+        out << "      \"allocations\": " << result.allocations << ",\n";
+        out << "      \"peak_rss_bytes\": " << result.peakRss << "\n    }";
+    }
+    out << "\n  ]\n}" << std::endl;
+}
+
+int main(int argn, char** argv)
+{
+    using namespace std;
+    using namespace just;
+
+    vector<string> corpora { "mixed", "deep", "wide", "numeric", "strings", "comments", "syntax" };
+    vector<size_t> sizes { 1 << 10, 1 << 20, 16 << 20 };
+    string filter, format = "console";
+    int repeats = 3, operations = 10000;
+    vector<measure> results;
+
+    for (int x = 1; x < argn; ++x) {
+        string arg = argv[x];
+        string value = arg.find('=') != string::npos ? arg.substr(arg.find('=') + 1) : string();
+        if (arg.compare(0, 8, "--sizes=") == 0) {
+            sizes.clear();
+            for (const string& size : split(value))
+                sizes.push_back(parse_size(size));
+        } else if (arg.compare(0, 10, "--corpora=") == 0)
+            corpora = split(value);
+        else if (arg.compare(0, 9, "--filter=") == 0)
+            filter = value;
+        else if (arg.compare(0, 9, "--format=") == 0)
+            format = value;
+        else if (arg.compare(0, 10, "--repeats=") == 0)
+            repeats = max(1, stoi(value));
+        else if (arg.compare(0, 13, "--operations=") == 0)
+            operations = max(1, stoi(value));
+        else {
+            cerr << "usage: just-bench [--sizes=1K,1M,16M,1G] [--corpora=mixed,deep,wide,numeric,strings,comments,syntax]" << endl
+                 << "                  [--filter=substring] [--format=console|json] [--repeats=3] [--operations=10000]" << endl;
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    syntax_file = argv[0];
+    syntax_file.erase(syntax_file.find_last_of("/\\") + 1);
+    syntax_file += "syntax.just";
+
+    auto report = [&](const measure& result) {
+        results.push_back(result);
+        if (format == "console")
+            print_console(result);
+    };
+
+    for (const string& kind : corpora) {
+        for (size_t size : sizes) {
+            string suffix = "/" + kind + "/" + size_name(size);
+            if (!filter.empty() && suffix.find(filter) == string::npos && kind.find(filter) == string::npos)
+                continue;
+
+            corpus data = generate(kind, size);
+            string output;
+            vector<string> paths(operations);
+            {
+                just_object_parser parser;
+                report(run_throughput("deserialize" + suffix, data, repeats, [&]() {
+                    parser.deserialize(data.source);
+                    return data.source.size();
+                }));
+                // statistics pass, then the build pass (see. JustAllocationMethod::fixed_allocation)
+                report(run_throughput("deserialize_two_pass" + suffix, data, repeats, [&]() {
+                    just_object_parser fixed(JustAllocationMethod::fixed_allocation);
+                    fixed.deserialize(data.source);
+                    return data.source.size();
+                }));
+                report(run_throughput("serialize_compact" + suffix, data, repeats, [&]() {
+                    output = parser.serialize(JustSerializeFormat::JustCompact);
+                    return output.size();
+                }));
+                report(run_throughput("serialize_beautify" + suffix, data, repeats, [&]() {
+                    output = parser.serialize(JustSerializeFormat::JustBeautify);
+                    return output.size();
+                }));
+
+                // lookup: block by pseudo-random index, path into it
+                for (int x = 0; x < operations; ++x)
+                    paths[x] = "b" + to_string(static_cast<unsigned>(x * 2654435761u) % data.blocks) + data.path;
+                report(run_latency("at" + suffix, data, operations, [&](int x) {
+                    if (!parser.at(paths[x]))
+                        throw runtime_error("path is not found: " + paths[x]);
+                }));
+                report(run_latency("search" + suffix, data, operations, [&](int) {
+                    if (!parser.search(data.pattern))
+                        throw runtime_error("search is not found: " + data.pattern);
+                }));
+            }
+        }
+    }
+
+    if (format == "json")
+        print_json(cout, results, repeats);
+    return 0;
+}
@@ -23,11 +23,21 @@ std::string get_exec_pwd(std::string app, const std::string& combine)
 
 }
 
+// see. tests.cpp
+int just_run_tests(const std::string& group, const std::string& testDirectory);
+
 int main(int argn, char** argv)
 {
+    using namespace std;
+
+    // group of the tests (see. CMakeLists.txt, ctest)
+    if (argn > 1)
+        return just_run_tests(argv[1], get_exec_pwd(*argv, "")) ? 1 : 0;
+
     just::just_object_parser parser;
 
     parser.deserialize_from(get_exec_pwd(*argv, "syntax.just"));
-    /* cout << parser.at("node_name/node_2/n2_word")->toString()
-          << parser.at("node_name/node_2/node_3/n3_word")->toString() << endl;*/
+
+    cout << parser.at("struct_tree/humans/human1/name")->to_string() << endl
+         << parser.at("struct_tree/humans/human2/age")->to_string() << endl;
 }
@@ -0,0 +1,762 @@
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+// Include justparser
+#include <justparser>
+
+using namespace just;
+
+// failed checks of the group
+static int failures = 0;
+
+static void check(bool result, const char* expression, const char* file, int line)
+{
+    if (result)
+        return;
+    ++failures;
+    std::cerr << file << ':' << line << ": check failed: " << expression << std::endl;
+}
+
+#define just_check(expression) check(static_cast<bool>(expression), #expression, __FILE__, __LINE__)
+
+// directory of the test files (see. just_run_tests)
+static std::string directory;
+
+static std::string test_file(const std::string& name) { return directory + '/' + name; }
+
+static void write_file(const std::string& filename, const std::string& content)
+{
+    std::ofstream file(filename, std::ios::binary);
+    file << content;
+}
+
+static std::string read_file(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// Document with every type, arrays and nested trees (names and strings is repeated for interning)
+static const char sample[] = "// sample\n"
+                             "user { name \"Alex\" age 19 score 2.5 ok true tags { \"a\", \"b\" } nums { 1, 2, 3, 4 } }\n"
+                             "humans { h1 { name \"Alex\" from \"Earth\" } h2 { name \"Jessy\" from \"Earth\" } }\n"
+                             "reals { 1.5, -2.25, 3e3 }\n"
+                             "bools { false, true }\n"
+                             "empty { }\n"
+                             "other 1\n";
+
+static void check_sample(just_object_parser& parser)
+{
+    just_check(parser.at("user/name") && parser.at("user/name")->to_string() == "Alex");
+    just_check(parser.at("user/age") && static_cast<jnumber>(*parser.at("user/age")) == 19);
+    just_check(parser.at("user/score") && static_cast<jreal>(*parser.at("user/score")) == 2.5);
+    just_check(parser.at("user/ok") && static_cast<jbool>(*parser.at("user/ok")));
+    just_check(parser.at("humans/h2/name") && parser.at("humans/h2/name")->to_string() == "Jessy");
+    just_check(parser.at("other") && static_cast<jnumber>(*parser.at("other")) == 1);
+    just_check(parser.at("empty") && parser.at("empty")->has_tree());
+    just_check(!parser.at("user/missing") && !parser.contains("humans/h3"));
+
+    just_span<jnumber> nums = parser.at("user/nums")->as_span<jnumber>();
+    just_check(nums.size() == 4 && nums[0] == 1 && nums[3] == 4);
+    just_span<jreal> reals = parser.at("reals")->as_span<jreal>();
+    just_check(reals.size() == 3 && reals[1] == -2.25 && reals[2] == 3000);
+    just_span<jbool> bools = parser.at("bools")->as_span<jbool>();
+    just_check(bools.size() == 2 && !bools[0] && bools[1]);
+}
+
+// serialize -> deserialize -> serialize is same
+static void check_round_trip(const just_object_parser& parser)
+{
+    for (JustSerializeFormat format : { JustSerializeFormat::JustCompact, JustSerializeFormat::JustBeautify }) {
+        jstring text = parser.serialize(format);
+        just_object_parser loaded;
+        loaded.deserialize(text);
+        just_check(loaded.serialize(format) == text);
+        just_check(loaded.serialize() == parser.serialize());
+
+        std::stringstream stream;
+        parser.serialize(stream, format);
+        just_check(stream.str() == text);
+    }
+}
+
+// Load the text by every load mode, check is called for every document
+static void check_loads(const jstring& text, const std::function<void(just_object_parser&)>& check_document)
+{
+    std::string filename = test_file("test-loads.just");
+    write_file(filename, text);
+
+    just_object_parser parser;
+    parser.deserialize(text);
+    check_document(parser);
+
+    for (JustLoadMethod method : { JustLoadMethod::buffered_read, JustLoadMethod::memory_map }) {
+        just_object_parser file;
+        file.deserialize_from(filename, method);
+        check_document(file);
+    }
+
+    just_object_parser parallel;
+    parallel.deserialize_parallel(text.data(), text.size(), 2);
+    check_document(parallel);
+
+    just_object_parser lazy;
+    lazy.deserialize_lazy(text.data(), text.size());
+    check_document(lazy);
+
+    just_object_parser incremental;
+    incremental.begin();
+    for (std::size_t x = 0; x < text.size(); ++x)
+        incremental.feed(text.data() + x, 1);
+    incremental.finish();
+    check_document(incremental);
+
+    std::string image = test_file("test-loads.justb");
+    parser.serialize_binary(image);
+    just_object_parser binary;
+    binary.deserialize_binary(image, true);
+    check_document(binary);
+}
+
+static void test_parse()
+{
+    just_object_parser parser;
+    parser.deserialize_from(test_file("syntax.just"));
+    just_check(parser.at("struct_tree/humans/human1/name")->to_string() == "Alex");
+    just_check(static_cast<jnumber>(*parser.at("struct_tree/humans/human2/age")) == 19);
+    just_check(parser.at("strings")->has_tree());
+    just_check(parser.at("mix")->has_tree());
+
+    just_path path = parser.compile("struct_tree/humans/human2/name");
+    just_check(parser.at(path) && parser.at(path)->to_string() == "Jessy");
+    just_check(parser.search("human2") && parser.search("human2")->has_tree());
+
+    just_object_parser sample_parser;
+    sample_parser.deserialize(sample, sizeof(sample) - 1);
+    check_sample(sample_parser);
+
+    just_object_parser fixed(JustAllocationMethod::fixed_allocation);
+    fixed.deserialize(sample, sizeof(sample) - 1);
+    check_sample(fixed);
+
+    // comments and spaces cross the blocks of the scanner, content after the length is not read
+    std::string text = "// " + std::string(100, '/') + "\n" + std::string(70, ' ') + "a {\r\n\t b 1 // " +
+                       std::string(80, '}') + "\n" + std::string(60, '\t') + "c \"x y\" }\nd 2 }}}";
+    just_object_parser spaced;
+    spaced.deserialize(text.data(), text.size() - 3);
+    just_check(spaced.at("a/b") && static_cast<jnumber>(*spaced.at("a/b")) == 1);
+    just_check(spaced.at("a/c") && spaced.at("a/c")->to_string() == "x y");
+    just_check(spaced.at("d") && static_cast<jnumber>(*spaced.at("d")) == 2);
+
+    // same buffer with other content is classified again
+    std::string reused = "a { b 1 }  c 2";
+    just_object_parser first;
+    first.deserialize(reused.data(), reused.size());
+    reused = "a 1 b { c 2 }";
+    just_object_parser second;
+    second.deserialize(reused.data(), reused.size());
+    just_check(first.at("a/b") && second.at("b/c") && static_cast<jnumber>(*second.at("b/c")) == 2);
+
+    // names with same characters and many names of one tree
+    std::string names;
+    for (int x = 0; x < 100; ++x)
+        names += "n" + std::to_string(x) + ' ' + std::to_string(x) + '\n';
+    names += "ab 1 ba 2 abc 3 cab 4";
+    just_object_parser wide;
+    wide.deserialize(names.data(), names.size());
+    bool found = true;
+    for (int x = 0; x < 100; ++x)
+        found = found && wide.at("n" + std::to_string(x)) && static_cast<jnumber>(*wide.at("n" + std::to_string(x))) == x;
+    just_check(found);
+    just_check(static_cast<jnumber>(*wide.at("ba")) == 2 && static_cast<jnumber>(*wide.at("cab")) == 4);
+    just_check(!wide.at("n100") && !wide.at("b"));
+
+    // braces in strings and comments of the array
+    check_loads("a { \"x}y\", \"z\" }\nb { \"{\" }\nc { 1, // }\n 2 }\nd { \"}\" }", [](just_object_parser& loaded) {
+        just_check(loaded.serialize() == "a{\"x}y\",\"z\"},b{\"{\"},c{1,2},d{\"}\"}");
+    });
+
+    // tree is not element of the array
+    just_object_parser nested;
+    just_parse_error error;
+    just_check(nested.try_deserialize("a { 1, { } }", 12, &error) == JustParseCode::InvalidValue);
+    just_check(error.column() == 8);
+}
+
+static void test_serialize()
+{
+    just_object_parser parser;
+    parser.deserialize(sample, sizeof(sample) - 1);
+    check_round_trip(parser);
+
+    just_object_parser syntax;
+    syntax.deserialize_from(test_file("syntax.just"));
+    check_round_trip(syntax);
+
+    just_object_parser loaded;
+    loaded.deserialize(parser.serialize(JustSerializeFormat::JustBeautify));
+    check_sample(loaded);
+}
+
+// strings with escaped characters: serialize -> deserialize is same (every format and load mode)
+static void test_escape()
+{
+    static const char* const values[] = { "C:\\", "\\", "a\"b", "\"", "\\\"", "end\\\\", "line\nnext", "\t\r\n", "\\n", "" };
+    just_object_parser parser;
+    just_object_node* array = parser.add_child("array", just_value::tree());
+    for (std::size_t x = 0; x < sizeof(values) / sizeof(*values); ++x) {
+        parser.add_child("v" + std::to_string(x), values[x]);
+        array->append(values[x]);
+    }
+    parser.add_child("last", 1);
+
+    for (JustSerializeFormat format : { JustSerializeFormat::JustCompact, JustSerializeFormat::JustBeautify }) {
+        jstring text = parser.serialize(format);
+        check_loads(text, [&](just_object_parser& loaded) {
+            for (std::size_t x = 0; x < sizeof(values) / sizeof(*values); ++x)
+                just_check(loaded.at("v" + std::to_string(x)) && loaded.at("v" + std::to_string(x))->to_string() == values[x]);
+            just_check(loaded.at("last") && static_cast<jnumber>(*loaded.at("last")) == 1);
+            just_check(loaded.serialize(format) == text);
+        });
+    }
+
+    just_object_parser source;
+    source.deserialize("a \"\\\\\" b 1");
+    just_check(source.at("a")->to_string() == "\\" && static_cast<jnumber>(*source.at("b")) == 1);
+
+    source.deserialize("a \"x\\ny\\tz\\r\\q\" b 1");
+    just_check(source.at("a")->to_string() == "x\ny\tz\rq" && static_cast<jnumber>(*source.at("b")) == 1);
+    just_check(source.serialize(JustSerializeFormat::JustCompact).find('\n') == jstring::npos);
+}
+
+// every load mode gives same document
+static void test_load()
+{
+    std::string filename = test_file("test-load.just");
+    write_file(filename, sample);
+
+    just_object_parser expected;
+    expected.deserialize(sample, sizeof(sample) - 1);
+    jstring text = expected.serialize();
+
+    for (JustLoadMethod method : { JustLoadMethod::buffered_read, JustLoadMethod::memory_map, JustLoadMethod::lazy_map }) {
+        just_object_parser file;
+        file.deserialize_from(filename, method);
+        check_sample(file);
+        just_check(file.serialize() == text);
+
+        // file is not found
+        just_object_parser missing;
+        bool thrown = false;
+        try {
+            missing.deserialize_from(test_file("test-missing.just"), method);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        just_check(thrown);
+    }
+
+    // parse error: previous document is released, files is not mapped
+    std::string broken = test_file("test-load-broken.just");
+    write_file(broken, "a { b 1 } c { d 2");
+    for (JustLoadMethod method : { JustLoadMethod::memory_map, JustLoadMethod::lazy_map }) {
+        just_object_parser file;
+        file.deserialize_from(filename, method);
+        bool thrown = false;
+        try {
+            file.deserialize_from(broken, method);
+        } catch (const just_parse_error&) {
+            thrown = true;
+        }
+        just_check(thrown);
+#if __linux__
+        just_check(read_file("/proc/self/maps").find("/test-load") == std::string::npos);
+#endif
+        file.deserialize_from(filename, method);
+        check_sample(file);
+    }
+
+    just_object_parser threads;
+    threads.deserialize_from(filename, JustLoadMethod::buffered_read, 4);
+    check_sample(threads);
+    just_check(threads.serialize() == text);
+
+    just_object_parser parallel;
+    parallel.deserialize_parallel(sample, sizeof(sample) - 1, 3);
+    check_sample(parallel);
+    just_check(parallel.serialize() == text);
+
+    just_object_parser lazy;
+    lazy.deserialize_lazy(sample, sizeof(sample) - 1);
+    check_sample(lazy);
+    just_check(lazy.serialize() == text);
+
+    // chunk splits any token
+    for (std::size_t chunk : { 1, 3, 7, 64 }) {
+        just_object_parser incremental;
+        incremental.begin();
+        for (std::size_t x = 0; x < sizeof(sample) - 1; x += chunk)
+            incremental.feed(sample + x, std::min(chunk, sizeof(sample) - 1 - x));
+        incremental.finish();
+        check_sample(incremental);
+        just_check(incremental.serialize() == text);
+    }
+}
+
+static void test_binary()
+{
+    std::string filename = test_file("test-binary.justb");
+    just_object_parser parser;
+    parser.deserialize(sample, sizeof(sample) - 1);
+    parser.serialize_binary(filename);
+
+    for (bool verify : { false, true }) {
+        just_object_parser image;
+        image.deserialize_binary(filename, verify);
+        check_sample(image);
+        just_check(image.serialize() == parser.serialize());
+        just_check(image.search("h1") != nullptr);
+    }
+
+    // not an image
+    write_file(filename, "text");
+    just_object_parser invalid;
+    bool thrown = false;
+    try {
+        invalid.deserialize_binary(filename);
+    } catch (const std::exception&) {
+        thrown = true;
+    }
+    just_check(thrown);
+
+    // first node of the tree is out of nodes (offset of the trees region is at 136 in header, tree is 8 bytes)
+    parser.serialize_binary(filename);
+    std::string image = read_file(filename);
+    std::uint64_t trees;
+    std::uint32_t offset = 0xFFFF0000;
+    std::memcpy(&trees, image.data() + 136, sizeof(trees));
+    std::memcpy(&image[trees + 8], &offset, sizeof(offset));
+    write_file(filename, image);
+    just_object_parser corrupted;
+    thrown = false;
+    try {
+        corrupted.deserialize_binary(filename);
+        corrupted.at("user/name");
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    just_check(thrown);
+}
+
+static void test_intern()
+{
+    just_object_parser parser;
+    parser.deserialize(sample, sizeof(sample) - 1);
+    just_memory_usage usage = parser.occupied_memory();
+    // "name", "from", "Alex", "Earth" is stored once
+    just_check(usage.stringReferences > usage.storedStrings);
+    just_check(usage.dedupRatio > 1.0);
+    just_check(usage.total.live > 0 && usage.total.reserved >= usage.total.live);
+    just_check(parser.at("humans/h1/from")->to_string() == parser.at("humans/h2/from")->to_string());
+
+    // strings with same prefix is not same
+    just_object_parser prefixes;
+    prefixes.deserialize("a \"ab\" b \"abc\" c \"ab\" ab \"a\"");
+    just_check(prefixes.at("a")->to_string() == "ab" && prefixes.at("b")->to_string() == "abc");
+    just_check(prefixes.at("c")->to_string() == "ab" && prefixes.at("ab")->to_string() == "a");
+}
+
+// numbers of the array as span, empty: array is not of numbers
+static std::vector<jnumber> number_span(just_object_node* array)
+{
+    try {
+        just_span<jnumber> span = array->as_span<jnumber>();
+        return std::vector<jnumber>(span.begin(), span.end());
+    } catch (const std::bad_cast&) {
+        return {};
+    }
+}
+
+// element of the array is edited to other type and back: span is only for array of one type
+static void test_array_edit()
+{
+    std::string filename = test_file("test-array.justb");
+    just_object_parser parser;
+    parser.deserialize("a{1,2} n 7");
+    // row of the array has capacity 4 after grow, element is not moved by next append
+    just_object_node* element = parser.at("a")->append(3);
+    parser.at("a")->append(4);
+    just_check(element->to_string() == "3");
+
+    element->set_value("str");
+    just_check(number_span(parser.at("a")).empty());
+    just_check(parser.serialize() == "a{1,2,\"str\",4},n 7");
+    parser.serialize_binary(filename);
+    just_object_parser mixed;
+    mixed.deserialize_binary(filename);
+    just_check(number_span(mixed.at("a")).empty());
+
+    element->set_value(9);
+    just_check(number_span(parser.at("a")) == std::vector<jnumber>({ 1, 2, 9, 4 }));
+    element->set_value(2.5);
+    just_check(number_span(parser.at("a")).empty());
+    element->set_value(9);
+    parser.at("a")->append(5);
+    just_check(number_span(parser.at("a")) == std::vector<jnumber>({ 1, 2, 9, 4, 5 }));
+    parser.serialize_binary(filename);
+    just_object_parser numbers;
+    numbers.deserialize_binary(filename);
+    just_check(number_span(numbers.at("a")) == std::vector<jnumber>({ 1, 2, 9, 4, 5 }));
+
+    // element of other type is appended, next number is not in the row
+    just_object_parser appended;
+    appended.deserialize("a{1,\"s\"} b 5");
+    appended.at("a")->append(2);
+    just_check(number_span(appended.at("a")).empty());
+    appended.serialize_binary(filename);
+    just_object_parser image;
+    image.deserialize_binary(filename);
+    just_check(number_span(image.at("a")).empty());
+    just_check(image.serialize() == "a{1,\"s\",2},b 5");
+}
+
+static void test_edit()
+{
+    just_object_parser parser;
+    parser.deserialize(sample, sizeof(sample) - 1);
+    just_path age = parser.compile("user/age");
+
+    parser.at("user/age")->set_value(20);
+    parser.at("user/score")->set_value(3.75);
+    parser.at("user/ok")->set_value(false);
+    parser.at("user/name")->set_value("Bob");
+    just_check(static_cast<jnumber>(*parser.at(age)) == 20);
+    just_check(static_cast<jreal>(*parser.at("user/score")) == 3.75);
+    just_check(!static_cast<jbool>(*parser.at("user/ok")));
+    just_check(parser.at("user/name")->to_string() == "Bob");
+
+    just_object_node* user = parser.at("user");
+    for (int x = 0; x < 20; ++x)
+        user->add_child("k" + std::to_string(x), x);
+    parser.at("user")->add_child("sub", just_value::tree())->add_child("deep", "x");
+    just_check(static_cast<jnumber>(*parser.at("user/k13")) == 13);
+    just_check(parser.at("user/sub/deep")->to_string() == "x");
+    just_check(static_cast<jnumber>(*parser.at(age)) == 20);
+
+    just_object_node* nums = parser.at("user/nums");
+    for (int x = 5; x <= 40; ++x)
+        nums->append(x);
+    just_span<jnumber> span = parser.at("user/nums")->as_span<jnumber>();
+    just_check(span.size() == 40 && span[0] == 1 && span[39] == 40);
+
+    just_check(parser.at("user")->remove_child("k5"));
+    just_check(!parser.at("user/k5") && parser.at("user/k6"));
+    just_check(!parser.at("user")->remove_child("k5"));
+    just_check(parser.remove_child("other") && !parser.at("other"));
+    parser.add_child("added", 1.5);
+    just_check(static_cast<jreal>(*parser.at("added")) == 1.5);
+
+    // names of the array, elements of the tree
+    bool thrown = false;
+    try {
+        parser.at("user/tags")->add_child("x", 1);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    just_check(thrown);
+
+    check_round_trip(parser);
+
+    // edit of the loaded binary image and lazy document
+    std::string filename = test_file("test-edit.justb");
+    parser.serialize_binary(filename);
+    just_object_parser image;
+    image.deserialize_binary(filename);
+    image.at("user/age")->set_value(99);
+    image.add_child("z", 1);
+    just_check(static_cast<jnumber>(*image.at("user/age")) == 99 && image.at("z"));
+
+    just_object_parser lazy;
+    lazy.deserialize_lazy(sample, sizeof(sample) - 1);
+    lazy.at("user/nums")->append(5);
+    just_check(lazy.at("user/nums")->as_span<jnumber>().size() == 5);
+
+    just_object_parser fresh;
+    fresh.add_child("fresh", "v");
+    just_check(fresh.serialize() == "fresh \"v\"");
+
+    // rows of the removed and grown trees is released, image of the document is valid
+    static const char rows[] = "a { x1 1 x2 2 } b { y1 1 y2 2 } c { z 1 } d 4";
+    for (bool grow : { false, true }) {
+        just_object_parser released;
+        released.deserialize(rows, sizeof(rows) - 1);
+        if (grow) {
+            released.at("a")->add_child("q", 1);
+            released.at("b")->add_child("r", 1);
+        } else {
+            released.remove_child("a");
+            released.remove_child("b");
+        }
+        released.serialize_binary(filename);
+        just_object_parser loaded;
+        loaded.deserialize_binary(filename, true);
+        just_check(loaded.serialize() == released.serialize());
+        just_check(static_cast<jnumber>(*loaded.at("c/z")) == 1 && static_cast<jnumber>(*loaded.at("d")) == 4);
+    }
+}
+
+// serialize after edits (only edited trees is written again) is same as a new document
+static void test_dirty()
+{
+    just_object_parser parser;
+    parser.deserialize(sample, sizeof(sample) - 1);
+    for (int step = 0; step < 50; ++step) {
+        switch (step % 5) {
+        case 0:
+            parser.at("user/age")->set_value(step);
+            break;
+        case 1:
+            parser.at("humans/h" + std::to_string(1 + step % 2))->add_child("n" + std::to_string(step), "v");
+            break;
+        case 2:
+            parser.at("user/nums")->append(step);
+            break;
+        case 3:
+            parser.at("humans/h1")->remove_child("n" + std::to_string(step - 2));
+            break;
+        case 4:
+            parser.at("humans/h2/name")->set_value(step);
+            break;
+        }
+        jstring text = parser.serialize();
+        just_object_parser expected;
+        expected.deserialize(text);
+        just_check(expected.serialize() == text);
+        just_check(static_cast<jnumber>(*expected.at("user/age")) == static_cast<jnumber>(*parser.at("user/age")));
+    }
+}
+
+static void test_reader()
+{
+    std::vector<just_event> events;
+    std::vector<std::string> names;
+    just_reader reader;
+    just_event event;
+    // by chunks of one character
+    for (std::size_t x = 0; x < sizeof(sample) - 1; ++x) {
+        reader.feed(sample + x, 1);
+        while (reader.next(event)) {
+            events.push_back(event);
+            if (event.event == JustEvent::PropertyName)
+                names.push_back(std::string(event.chars, event.length));
+        }
+    }
+    reader.finish();
+    while (reader.next(event))
+        events.push_back(event);
+
+    int depth = 0, trees = 0, values = 0, elements = 0;
+    for (const just_event& e : events) {
+        if (e.event == JustEvent::BeginTree)
+            ++depth, ++trees;
+        else if (e.event == JustEvent::EndTree)
+            --depth;
+        else if (e.event == JustEvent::Value)
+            ++values;
+        else if (e.event == JustEvent::ArrayElement)
+            ++elements;
+    }
+    just_check(depth == 0);
+    just_check(trees == 9);
+    just_check(values == 9);
+    just_check(elements == 11);
+    just_check(!names.empty() && names.front() == "user" && names.back() == "other");
+
+    std::stringstream stream(sample);
+    int count = 0;
+    just_reader::read(
+        stream, [&count](const just_event&) { ++count; }, 5);
+    just_check(count == static_cast<int>(events.size()));
+}
+
+static void test_errors()
+{
+    struct {
+        const char* source;
+        JustParseCode code;
+        int line;
+        int column;
+    } cases[] = {
+        { "a 1\nb { c ? }", JustParseCode::InvalidValue, 2, 7 },
+        { "a { b 1 ", JustParseCode::UnclosedTree, 1, 9 },
+        { "a { 1 ", JustParseCode::UnclosedTree, 1, 7 },
+        { "a { 1, \"x ", JustParseCode::UnclosedString, 1, 8 },
+        { "a \"text", JustParseCode::UnclosedString, 1, 3 },
+        { "a 1 }", JustParseCode::UnopenedTree, 1, 5 },
+        { "1a 2", JustParseCode::InvalidName, 1, 1 },
+        { "a", JustParseCode::UnexpectedEnd, 0, 0 },
+    };
+    for (const auto& c : cases) {
+        just_object_parser parser;
+        just_parse_error error;
+        JustParseCode code = parser.try_deserialize(c.source, std::strlen(c.source), &error);
+        just_check(code == c.code && error.code() == c.code);
+        if (c.line) {
+            just_check(error.line() == c.line);
+            just_check(error.column() == c.column);
+        }
+        just_check(!parser.at("a"));
+
+        bool thrown = false;
+        try {
+            parser.deserialize(c.source, std::strlen(c.source));
+        } catch (const just_parse_error& e) {
+            thrown = e.code() == c.code;
+        }
+        just_check(thrown);
+    }
+
+    just_object_parser parser;
+    just_check(parser.try_deserialize(sample, sizeof(sample) - 1) == JustParseCode::Ok);
+    check_sample(parser);
+}
+
+static void test_document()
+{
+    std::string filename = test_file("test-document.just");
+    write_file(filename, "value 0\ntree { number 0 }");
+
+    just_document document;
+    just_check(!document.snapshot());
+    document.reload(filename);
+
+    std::atomic<bool> stop(false);
+    std::atomic<int> bad(0);
+    std::vector<std::thread> readers;
+    for (int x = 0; x < 4; ++x)
+        readers.emplace_back([&]() {
+            while (!stop) {
+                std::shared_ptr<just_object_parser> view = document.snapshot();
+                just_object_node* value = view->at("value");
+                just_object_node* number = view->at("tree/number");
+                // both values is from one snapshot
+                if (!value || !number || static_cast<jnumber>(*value) != static_cast<jnumber>(*number))
+                    ++bad;
+            }
+        });
+    for (int x = 1; x <= 20; ++x) {
+        write_file(filename, "value " + std::to_string(x) + "\ntree { number " + std::to_string(x) + " }");
+        document.reload(filename);
+    }
+    stop = true;
+    for (std::thread& reader : readers)
+        reader.join();
+    just_check(bad == 0);
+    just_check(static_cast<jnumber>(*document.snapshot()->at("value")) == 20);
+
+    // published document is read only
+    bool thrown = false;
+    try {
+        document.snapshot()->deserialize("a 1");
+    } catch (const std::logic_error&) {
+        thrown = true;
+    }
+    just_check(thrown);
+}
+
+// first parse of the process is in several threads (classify method is selected once), documents is published concurrently
+static void test_concurrent()
+{
+    const int threads = 8;
+    jstring text(sample, sizeof(sample) - 1);
+    just_document document;
+    std::atomic<bool> go(false);
+    std::atomic<int> bad(0);
+    std::vector<jstring> results(threads);
+    std::vector<std::thread> workers;
+
+    for (int x = 0; x < threads; ++x)
+        workers.emplace_back([&, x]() {
+            while (!go)
+                std::this_thread::yield();
+            for (int y = 0; y < 20; ++y) {
+                std::unique_ptr<just_object_parser> parser(new just_object_parser());
+                switch ((x + y) % 3) {
+                case 0:
+                    parser->deserialize(text);
+                    break;
+                case 1:
+                    parser->deserialize_parallel(text.data(), text.size(), 2);
+                    break;
+                default:
+                    parser->deserialize_lazy(text.data(), text.size());
+                    break;
+                }
+                if (parser->at("user/name")->to_string() != "Alex" || static_cast<jnumber>(*parser->at("user/age")) != 19)
+                    ++bad;
+                results[x] = parser->serialize();
+                document.publish(std::move(parser));
+                std::shared_ptr<just_object_parser> view = document.snapshot();
+                if (!view || view->serialize() != results[x])
+                    ++bad;
+            }
+        });
+    go = true;
+    for (std::thread& worker : workers)
+        worker.join();
+    just_check(bad == 0);
+
+    just_object_parser parser;
+    parser.deserialize(text);
+    for (const jstring& result : results)
+        just_check(result == parser.serialize());
+}
+
+// Run group of the tests, files of the tests is in directory. Returns failed checks
+int just_run_tests(const std::string& group, const std::string& testDirectory)
+{
+    static const struct {
+        const char* name;
+        void (*run)();
+    } groups[] = {
+        { "parse", test_parse },
+        { "serialize", test_serialize },
+        { "escape", test_escape },
+        { "load", test_load },
+        { "binary", test_binary },
+        { "intern", test_intern },
+        { "edit", test_edit },
+        { "array", test_array_edit },
+        { "dirty", test_dirty },
+        { "reader", test_reader },
+        { "errors", test_errors },
+        { "document", test_document },
+        { "concurrent", test_concurrent },
+    };
+
+    directory = testDirectory;
+    for (const auto& g : groups) {
+        if (group != g.name)
+            continue;
+        try {
+            g.run();
+        } catch (const std::exception& e) {
+            ++failures;
+            std::cerr << group << ": exception: " << e.what() << std::endl;
+        }
+        return failures;
+    }
+    std::cerr << "unknown test group: " << group << std::endl;
+    return 1;
+}
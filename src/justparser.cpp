@@ -11,18 +11,52 @@
  */
 
 #include <cstdlib>
+#include <cstddef>
+#include <cstdio>
+#include <cmath>
+#include <new>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <exception>
 #include <vector>
 #include <tuple>
 #include <climits>
 #include <stack>
 #include <iostream>
 #include <set>
+#include <clocale>
+#include <locale>
+#include <sstream>
+#include <iomanip>
 
 // import header
 #include "justparser"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JUST_SCAN_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(JUST_SCAN_SSE2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define JUST_SCAN_AVX2 1
+#include <immintrin.h>
+#endif
+
+// diagnostics sink of the parser (see. just_object_parser::set_diagnostics), without it the calls is not compiled
+#ifndef JUST_DIAGNOSTICS
+#define JUST_DIAGNOSTICS 0
+#endif
+
+#if defined(__GLIBC__) || WIN32
+#include <malloc.h>
+#endif
+
 #if __unix__ || __linux__
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #elif WIN32
 #include <windows.h>
 #endif
@@ -33,13 +67,25 @@
 
 namespace just
 {
-typedef jvariant jnode_t;
-typedef std::vector<int> jtree_t;
-
-enum { Node_ValueFlag = 1, Node_ArrayFlag = 2, Node_TreeFlag = 3 };
-
 /* Internal Pointer (IPT) */
-enum { Invalid_IPT = -1 };
+// high bits: type (see. JustType), low bits: index in typed region (vault)
+enum { Invalid_IPT = -1, IPT_TypeShift = 28, IPT_IndexMask = (1 << IPT_TypeShift) - 1 };
+
+// node of the tree: property name and value
+struct jnode_t {
+    // property name (IPT of string), Invalid_IPT for element of array
+    int name;
+    // value (IPT)
+    int value;
+};
+
+// tree: nodes in a row (see. just_storage::nodes)
+struct jtree_t {
+    // first node
+    std::uint32_t offset;
+    // count of nodes
+    std::uint32_t length;
+};
 
 // NOTE: storage description
 /*
@@ -52,19 +98,73 @@ enum { Invalid_IPT = -1 };
             4       trees
 
             ------------------------
-            ISSUE:
-            - Organize structure malloc (realloc)
-            - Tree for node
-                - How to get answer ? First use unsigned int as pointer in linear.
+            TREE:
+            - jtree_t refer to nodes in a row (just_storage::nodes)
+            - jnode_t refer to name (string) and value by IPT
+            - root tree is first tree (IPT of tree 0)
 
             VAULT:
             - bools(0), numbers(1), reals(2), strings(3), trees(4)
 
+            INDEX:
+            - strings are interned (content -> string), equal names have equal IPT
+            - names of the tree in open addressing table (hash -> node), built after load
+            - search table (name -> first node by wide), built on first search
+
     */
+// string field (element of the strings vault)
+struct just_string_t {
+    // offset of the first character (string pool or borrowed source)
+    std::uint64_t offset;
+    // length of the string (bytes)
+    std::uint32_t length;
+    // see. String_PoolFlag
+    std::uint32_t flags;
+};
+
+enum { String_PoolFlag = 0, String_BorrowedFlag = 1 };
+
+// slot of the names index (open addressing), see. just_storage_build_index
+struct just_index_slot {
+    // node index in storage (Index_Empty is free slot)
+    std::uint32_t node;
+    // high bits of the name hash
+    std::uint32_t tag;
+};
+
+// trees is shorter Index_MinLength are scanned (without index)
+enum : std::uint32_t { Index_Empty = UINT32_MAX, Index_MinLength = 8 };
+
+// content of the pending tree in the borrowed source (between braces), begin is zero - tree is parsed
+struct just_lazy_block {
+    jnumber begin;
+    jnumber end;
+    jbool array;
+};
+
+// row of the nodes per tree in mutable document (see. just_storage_thaw)
+struct just_row {
+    std::uint32_t capacity;
+    // values of the array is reserved in a row after first element (see. just_storage_alloc_element)
+    std::uint32_t values;
+    // tree of the tree (root: -1)
+    int parent;
+    // tree is edited after last serialization (parents also), see. just_storage_touch
+    std::uint32_t dirty;
+    // content of the tree (between braces) in text of the last serialization, offset from content of the parent
+    jnumber textOffset;
+    jnumber textLength;
+};
+
+// row of the new tree: is not serialized
+static const just_row Row_Empty = { 0, 0, -1, 1, 0, 0 };
+
 struct just_storage {
 
     // Has storage state
     std::uint8_t optimized;
+    // regions refer to binary image (see. just_storage_image), is not released
+    std::uint8_t external;
 
     // up members  : meta-info
     // down members: size-info
@@ -78,7 +178,67 @@ struct just_storage {
     jnumber arrayNumbers;
     jnumber arrayReals;
     jnumber arrayStrings;
-    void* vault;
+
+    // reserved elements in vault (same order as vault)
+    jnumber reserved[5];
+
+    // string pool (characters of the copied strings)
+    char* pool;
+    jnumber poolSize;
+    jnumber poolReserved;
+
+    // borrowed source (mapped file), strings can refer to without copy
+    const char* source;
+    jnumber sourceLength;
+
+    // nodes of the trees (jnode_t), a tree refer to a row
+    jnode_t* nodes;
+    jnumber numNodes;
+    jnumber nodesReserved;
+
+    // typed regions: bools(0), numbers(1), reals(2), strings(3), trees(4)
+    void* vault[5];
+
+    // one block for all regions in a row (fixed allocation or optimized state), see. just_storage_arena
+    void* arena;
+    jnumber arenaSize;
+
+    // names index of the trees: first slot per tree, capacity from length (see. just_index_capacity)
+    just_index_slot* index;
+    jnumber* indexTables;
+    jnumber indexSize;
+    // grown by trees parsed later (lazy document, see. just_storage_index_tree)
+    jnumber indexReserved;
+    jnumber indexTrees;
+    jnumber indexTablesReserved;
+
+    // names index of the search: first node by wide from root (see. just_storage_build_search)
+    just_index_slot* searchIndex;
+    jnumber searchCapacity;
+
+    // interned strings: distinct string is stored once, slot node is string index (see. just_storage_intern)
+    just_index_slot* intern;
+    jnumber internCapacity;
+    // references to the stored strings (duplicates is released)
+    jnumber internHits;
+    // hash per stored string (see. just_node_name_hash), is not in binary image
+    std::uint64_t* hashes;
+    jnumber hashesReserved;
+
+    // lazy document: block of the source per tree, pending tree is parsed on access (see. just_storage_materialize)
+    just_lazy_block* lazy;
+    jnumber lazyReserved;
+
+    // mutable document: row per tree, released rows by size (power of two), see. just_storage_thaw
+    just_row* rows;
+    jnumber rowsReserved;
+    int freeRows[32];
+    // tree per node of the rows (mutable document)
+    std::uint32_t* owners;
+    jnumber ownersReserved;
+    // last compact serialization of the mutable document, clean trees is copied from (see. just_serialize_edited)
+    char* text;
+    jnumber textSize;
 };
 
 static const struct {
@@ -92,6 +252,8 @@ static const struct {
     char just_commentLine[3] = "//";
     // member for use Screening character symbol (\n, \r, \m, etc.)
     char just_left_seperator = '\\';
+    // member for use escape sequences of the string: letter after the screening character, control character
+    char just_escape_segments[2][3] { { 'n', 'r', 't' }, { '\n', '\r', '\t' } };
     // member for use end of line (EOF).
     char just_eol_segment = '\n';
     // member for use string compact
@@ -117,27 +279,28 @@ static const struct {
 } just_syntax;
 
 struct just_stats {
-    std::uint16_t jstrings;
-    std::uint32_t jstrings_total_bytes;
-    std::uint16_t jnumbers;
-    std::uint16_t jreals;
-    std::uint16_t jbools;
-    std::uint16_t jarrstrings;
-    std::uint32_t jarrstrings_total_bytes;
-    std::uint16_t jarrnumbers;
-    std::uint32_t jarrnumbers_total_bytes;
-    std::uint16_t jarrreals;
-    std::uint32_t jarrreals_total_bytes;
-    std::uint16_t jarrbools;
-    std::uint32_t jarrbools_total_bytes;
-    std::uint16_t jdepths;
+    // values (elements of arrays are included)
+    jnumber jstrings;
+    jnumber jstrings_total_bytes;
+    jnumber jnumbers;
+    jnumber jreals;
+    jnumber jbools;
+    // arrays by type of first element
+    jnumber jarrstrings;
+    jnumber jarrnumbers;
+    jnumber jarrreals;
+    jnumber jarrbools;
+    // trees (arrays are included) and nodes
+    jnumber jtrees;
+    jnumber jnodes;
+    jnumber jdepths;
 
     const jnumber calcBytes() const
     {
         jnumber sz;
 
         // calc jstring
-        sz = jstrings_total_bytes;
+        sz = jstrings_total_bytes + jstrings * sizeof(just_string_t);
 
         // calc jnumber
         sz += jnumbers * sizeof(jnumber);
@@ -148,63 +311,157 @@ struct just_stats {
         // calc jbools
         sz += jbools * sizeof(jbool);
 
-        // calc arrays
-        sz += jarrstrings_total_bytes + jarrnumbers_total_bytes + jarrbools_total_bytes + jarrreals_total_bytes;
+        // calc trees
+        sz += jtrees * sizeof(jtree_t) + jnodes * sizeof(jnode_t);
 
         return sz;
     }
 };
 
+// diagnostics of the parse: sink, level and begin of the source (for offsets)
+struct just_tracer {
+    const just_diagnostics* sink;
+    JustDiagnostic level;
+    const char* origin;
+    // sink is shared by threads (see. deserialize_parallel)
+    std::mutex* lock;
+};
+
+// syntax fault of the parse (see. just_avail), thrown as just_parse_error by caller
+struct just_fault {
+    JustParseCode code;
+    // position in the source
+    const char* position;
+    // expected token
+    const char* expected;
+};
+
+// message to the diagnostics sink when level is enabled, without JUST_DIAGNOSTICS it is nothing
+#if JUST_DIAGNOSTICS
+#define just_trace(tracer, lvl, ...)                                    \
+    do {                                                                \
+        if ((tracer) && (tracer)->level >= (lvl))                       \
+            just_trace_emit((tracer), (lvl), __VA_ARGS__);              \
+    } while (0)
+#else
+// tracer and depth is used (without warnings of the unused parameters)
+#define just_trace(tracer, lvl, event, type, depth, ...) ((void) (tracer), (void) (depth))
+#endif
+
+// structural masks of the block (see. just_scan_index), bit per character
+struct just_block_masks {
+    // trimming characters (see. just_trim_segments)
+    std::uint64_t space;
+    // block first segment '{'
+    std::uint64_t open;
+    // block end segment '}'
+    std::uint64_t close;
+    // array data seperator ','
+    std::uint64_t obstacle;
+    // string format '"'
+    std::uint64_t quote;
+    // first character of the comment line "//" (last character of the block is candidate, next is in next block)
+    std::uint64_t comment;
+    // end of line and null-terminator
+    std::uint64_t eol;
+};
+
+enum { Block_Size = 64 };
+
+// blocks of the scan window (64 KB of content), see. just_scan_masks
+enum { Scan_Window = 1024 };
+
+// Structural masks of the content by blocks (Block_Size), blocks is aligned to begin of the content.
+// The tokenizer walks it forward: blocks is classified on first query and kept in window,
+// the window is started again on query before it or after it (see. Scan_Window, just_scan_masks)
+struct just_scan_index {
+    const char* begin;
+    jnumber length;
+    // first block of the window
+    jnumber first;
+    std::vector<just_block_masks> blocks;
+};
+
 method inline int system_get_page_size();
+method void* system_map_file(const char* filename, jnumber* length);
+method void system_unmap_file(void* mapping, jnumber length);
+method jnumber system_block_size(const void* block, jnumber size);
 
 method inline int just_type_size(const JustType type);
 
 /*storage*/
 method inline just_storage* just_storage_new_init();
+method void just_storage_deinit(just_storage* pstorage);
 method jvariant just_storage_get_vault(const just_storage* pstorage, const JustType type);
 method std::uint32_t just_storage_get_vault_info(const just_storage* pstorage, JustType type);
+method void just_storage_reserve(just_storage* pstore, const just_stats& jstat);
+method void just_storage_arena(just_storage* pstore, const jnumber* counts, jnumber numNodes, jnumber poolBytes, bool withPool);
+method inline bool just_storage_in_arena(const just_storage* pstore, const void* block);
 method jvariant just_storage_alloc_field(just_storage** pstore, JustType type, int size);
 method int just_storage_get_ipt(const just_storage* pstorage, const jvariant pointer);
 method jvariant just_storage_get_pointer(const just_storage* pstore, const int ipt);
-method jtree_t* just_storage_alloc_tree(just_storage** pstore, jtree_t* owner);
-method jvariant just_storage_alloc_array(just_storage** pstore, JustType arrayType);
+method int just_storage_alloc_tree(just_storage** pstore);
+method void just_storage_commit_tree(just_storage** pstore, int ipt, const jnode_t* nodes, int length);
+method const void* just_storage_get_span(const just_storage* pstore, int tree, JustType type, jnumber* length);
 method bool just_storage_optimize(just_storage** pstorage);
+method void just_storage_usage(const just_storage* pstore, just_memory_usage* usage);
+method void just_storage_merge(just_storage* pstore, just_storage* const* shards, std::size_t count);
 method JustType just_storage_get_type(const just_storage* pstorage, const void* pointer);
+method const jnode_t* just_storage_find_node(const just_storage* pstore, int tree, const char* name, int length, std::uint64_t hash = 0);
+method int just_storage_intern(just_storage* pstore, std::uint64_t hash = 0);
+method int just_storage_find_string(const just_storage* pstore, const char* chars, int length, std::uint64_t hash);
+method void just_storage_index_tree(just_storage* pstore, int tree);
+method void just_storage_thaw(just_storage* pstore);
+method int just_storage_alloc_value(just_storage* pstore, JustType type, const void* data, std::size_t length);
+method int just_storage_alloc_element(just_storage* pstore, int tree, JustType type);
+method jnumber just_storage_move_row(just_storage* pstore, int tree, JustType type, jnumber reserve);
+method void just_storage_arrange_row(just_storage* pstore, int tree);
+method std::uint32_t just_storage_add_node(just_storage* pstore, int tree, int name, int value);
+method void just_storage_remove_node(just_storage* pstore, int tree, std::uint32_t node);
+method void just_storage_release_tree(just_storage* pstore, int tree);
+method void just_storage_link_row(just_storage* pstore, int tree);
+method void just_storage_touch(just_storage* pstore, int tree);
+
+/*scanner*/
+method void just_classify_scalar(const char* block, just_block_masks* masks);
+method inline just_scan_index just_scan_content(const char* begin, jnumber length);
+method inline const just_block_masks* just_scan_masks(just_scan_index* scan, jnumber block);
 
 /*parser*/
-method inline int just_string_to_hash_fast(const char* char_side, int contentLength);
+method inline int just_ipt_make(const JustType type, jnumber index);
+method inline JustType just_ipt_type(const int ipt);
+method inline int just_ipt_index(const int ipt);
+method inline std::uint64_t just_string_hash(const char* char_side, int contentLength);
 method inline bool just_is_unsigned_jnumber(const char char_side);
-method inline bool just_is_jnumber(const char* char_side, int* getLength);
-method jbool just_is_jreal(const char* char_side, int* getLength);
-method inline jbool just_is_jbool(const char* char_side, int* getLength);
-method int just_get_format(const char* char_side, just_storage** storage, JustType& containType, jvariant* outValue);
-method inline jbool just_has_datatype(const char* char_side);
-method int just_trim(const char* char_side, int contentLength);
-method int just_skip(const char* char_side, int length);
+method int just_scan_string(const char* char_side, int contentLength, jbool* escaped);
+method int just_unescape(const char* char_side, int length, char* out);
+method void just_write_real(jstring& out, jreal value);
+method int just_scan_number(const char* char_side, int contentLength, JustType* containType, jnumber* number, jreal* real);
+method inline bool just_is_jnumber(const char* char_side, int contentLength, int* getLength);
+method jbool just_is_jreal(const char* char_side, int contentLength, int* getLength);
+method inline jbool just_is_jbool(const char* char_side, int contentLength, int* getLength);
+method int just_get_format(const char* char_side, int contentLength, just_storage** storage, JustType& containType, int* outValue);
+method inline jbool just_has_datatype(const char* char_side, int contentLength);
+method int just_trim(just_scan_index* scan, const char* char_side, int contentLength);
+method int just_skip(just_scan_index* scan, const char* char_side, int length);
 method inline jbool just_valid_property_name(const char* char_side, int len);
 method inline jbool just_is_comment_line(const char* char_side, int len);
-method inline int just_has_eol(const char* pointer, int len);
-method int just_autoskip_comment(const char* char_side, int len);
+method inline int just_has_eol(just_scan_index* scan, const char* pointer, int len);
+method int just_autoskip_comment(just_scan_index* scan, const char* char_side, int len);
 method inline jbool just_is_space(const char char_side);
-method jbool just_is_array(const char* char_side, int& endpoint, int contentLength);
-method void just_avail_only(just_stats& jstat, const char* source, int length);
-method void just_avail(just_storage** pstore, just_stats& jstat, const char* source, int length);
-method int bug_just_avail(just_storage** storage, just_stats& eval, const char* source, int length, int depth);
+method jbool just_is_array(just_scan_index* scan, const char* char_side, int& endpoint, int contentLength);
+method void just_split_blocks(const char* source, jnumber length, jnumber minimum, std::vector<jnumber>& bounds);
+method void just_trace_emit(const just_tracer* tracer, JustDiagnostic level, JustEvent event, JustType type, int depth, const char* position, const char* chars, int length);
+method jnumber just_block_end(just_scan_index* scan, const char* source, jnumber length);
+method just_fault just_avail_array(just_storage** pstore, just_stats* jstat, just_scan_index* scan, const char* pointer, int x, int z, std::vector<jnode_t>& nodes, const just_tracer* tracer, int depth);
+method just_fault just_avail(just_storage** pstore, just_stats* jstat, const char* source, int length, const just_tracer* tracer = nullptr, int tree = Invalid_IPT);
+method void just_storage_materialize(just_storage* pstore, int tree);
+method void just_storage_materialize_all(just_storage* pstore);
 
-method inline int just_type_size(const JustType type)
-{
-    switch (type) {
-    case JustType::JustBoolean:
-        return sizeof(jbool);
-    case JustType::JustNumber:
-        return sizeof(jnumber);
-    case JustType::JustReal:
-        return sizeof(jreal);
-    case JustType::JustTree:
-        return sizeof(jtree_t);
-    }
-    return 0;
-}
+// size of the value by type: Unknown, Null, Boolean, Number, Real, String, Tree (index is type + 1, all tags of the IPT)
+static const std::uint8_t just_type_sizes[1 + (1 << (31 - IPT_TypeShift))] = { 0, 0, sizeof(jbool), sizeof(jnumber), sizeof(jreal), sizeof(just_string_t), sizeof(jtree_t) };
+
+method inline int just_type_size(const JustType type) { return just_type_sizes[static_cast<int>(type) + 1]; }
 
 method inline int system_get_page_size()
 {
@@ -221,38 +478,149 @@ method inline int system_get_page_size()
     return _PAGE_SIZE;
 }
 
+// method for map file to memory (read only). Return nullptr for empty file
+method void* system_map_file(const char* filename, jnumber* length)
+{
+    void* mapping = nullptr;
+    *length = 0;
+#if __unix__ || __linux__
+    struct stat fileStat;
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1)
+        throw std::runtime_error("error open file");
+
+    if (fstat(fd, &fileStat) == -1) {
+        close(fd);
+        throw std::runtime_error("error stat file");
+    }
+
+    if (fileStat.st_size > 0) {
+        mapping = mmap(nullptr, static_cast<std::size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("error map file");
+        }
+        // parser read sequentially
+        madvise(mapping, static_cast<std::size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+        *length = static_cast<jnumber>(fileStat.st_size);
+    }
+    // mapping is alive after close
+    close(fd);
+#elif WIN32
+    LARGE_INTEGER fileSize;
+    HANDLE hFile = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("error open file");
+
+    if (!GetFileSizeEx(hFile, &fileSize)) {
+        CloseHandle(hFile);
+        throw std::runtime_error("error stat file");
+    }
+
+    if (fileSize.QuadPart > 0) {
+        HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (hMapping)
+            mapping = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+        // view is alive after close
+        if (hMapping)
+            CloseHandle(hMapping);
+        if (mapping == nullptr) {
+            CloseHandle(hFile);
+            throw std::runtime_error("error map file");
+        }
+        *length = static_cast<jnumber>(fileSize.QuadPart);
+    }
+    CloseHandle(hFile);
+#else
+    throw std::runtime_error("memory map is not supported");
+#endif
+    return mapping;
+}
+
+// method for unmap file from memory
+method void system_unmap_file(void* mapping, jnumber length)
+{
+    if (mapping == nullptr)
+        return;
+#if __unix__ || __linux__
+    munmap(mapping, static_cast<std::size_t>(length));
+#elif WIN32
+    UnmapViewOfFile(mapping);
+#endif
+}
+
+// method for get allocated size of the block (requested size at least), allocator slack is included when it is known
+method jnumber system_block_size(const void* block, jnumber size)
+{
+    jnumber usable;
+    if (block == nullptr)
+        return 0;
+#if defined(__GLIBC__)
+    usable = malloc_usable_size(const_cast<void*>(block));
+#elif WIN32
+    usable = _msize(const_cast<void*>(block));
+#else
+    usable = size;
+#endif
+    return usable < size ? size : usable;
+}
+
 // method for create and init new storage.
 method just_storage* just_storage_new_init()
 {
     just_storage* ptr;
-    int pgSize = system_get_page_size();
-    pgSize = sizeof(just_storage) > pgSize ? sizeof(just_storage) : pgSize;
-    if (!(ptr = static_cast<just_storage*>(std::malloc(pgSize))))
+    if (!(ptr = static_cast<just_storage*>(std::malloc(sizeof(just_storage)))))
         throw std::bad_alloc();
 
     // init as 0
-    std::memset(ptr, 0, pgSize);
-    // copy self address
-    std::size_t addr = std::size_t(&ptr->vault);
-    std::memcpy(&ptr->vault, &addr, sizeof(std::size_t));
+    std::memset(ptr, 0, sizeof(just_storage));
     return ptr;
 }
+
+// Get typed region (vault) from type order
 method jvariant just_storage_get_vault(const just_storage* pstorage, const JustType type)
 {
-    if (type < JustType::JustBoolean)
+    if (type < JustType::JustBoolean || type > JustType::JustTree)
         // vault is not supported
         return nullptr;
 
-    jvariant _vp = reinterpret_cast<jvariant>((reinterpret_cast<std::size_t>(pstorage->vault) + (int(type) - 1) * sizeof(void*)));
-    return _vp;
+    return pstorage->vault[static_cast<int>(type) - 1];
 }
 
-method void just_storage_deinit(just_storage* pstorage){
-
-    free(pstorage);
+method void just_storage_deinit(just_storage* pstorage)
+{
+    if (pstorage == nullptr)
+        return;
+
+    std::free(pstorage->searchIndex);
+    std::free(pstorage->hashes);
+    if (pstorage->external) {
+        // regions and index in binary image
+        std::free(pstorage);
+        return;
+    }
+    std::free(pstorage->index);
+    std::free(pstorage->indexTables);
+    std::free(pstorage->intern);
+    std::free(pstorage->lazy);
+    std::free(pstorage->rows);
+    std::free(pstorage->owners);
+    std::free(pstorage->text);
+    if (pstorage->arena) {
+        // regions in a row, pool can be separated (borrowed source)
+        if (!just_storage_in_arena(pstorage, pstorage->pool))
+            std::free(pstorage->pool);
+        std::free(pstorage->arena);
+    } else {
+        for (int x = 0; x < static_cast<int>(sizeof(pstorage->vault) / sizeof(pstorage->vault[0])); ++x)
+            std::free(pstorage->vault[x]);
+        std::free(pstorage->nodes);
+        std::free(pstorage->pool);
+    }
+    std::free(pstorage);
 }
 
-// Get storage size from type order
+// Get count of elements from type order
 method std::uint32_t just_storage_get_vault_info(const just_storage* pstorage, JustType type)
 {
     std::uint32_t calcSize;
@@ -260,12 +628,9 @@ method std::uint32_t just_storage_get_vault_info(const just_storage* pstorage, J
     if (!pstorage)
         throw std::bad_alloc();
 
-    if (type > JustType::Null) {
-        // move pointer to ...
-        const jnumber* alpha = reinterpret_cast<const jnumber*>(reinterpret_cast<std::size_t>(pstorage) + sizeof(pstorage->optimized)) + static_cast<int>(type);
-
-        // low - count ~ high - sizes (all bytes)
-        calcSize = (*alpha) >> 32;
+    if (type > JustType::Null && type <= JustType::JustTree) {
+        // counters has a vault order
+        calcSize = static_cast<std::uint32_t>((&pstorage->numBools)[static_cast<int>(type) - 1]);
     } else {
         // set to zero
         calcSize = 0;
@@ -274,33 +639,160 @@ method std::uint32_t just_storage_get_vault_info(const just_storage* pstorage, J
     return calcSize;
 }
 
-// method for get type from pointer (storage required)
-method JustType just_storage_get_type(const just_storage* pstorage, const void* pointer)
+// Block is part of the arena (empty region can point to end of the arena)
+method inline bool just_storage_in_arena(const just_storage* pstore, const void* block)
 {
-    const jnumber* alpha = reinterpret_cast<jnumber*>(reinterpret_cast<std::size_t>(pstorage) + sizeof(pstorage->optimized));
-    const void* delta = pstorage->vault;
-    int type;
-    if (pointer) {
-        type = static_cast<int>(JustType::JustBoolean);
-        if (pstorage->optimized) {
-            for (; pointer < delta; ++alpha) {
+    return pstore->arena && block >= pstore->arena && block <= static_cast<const char*>(pstore->arena) + pstore->arenaSize;
+}
+
+// Grow block for count of elements, realloc when required
+method void just_storage_grow(void** block, jnumber* reserved, jnumber count, int elementSize, jnumber initial)
+{
+    if (count > *reserved) {
+        jnumber newReserved = *reserved ? *reserved : initial;
+        while (newReserved < count)
+            newReserved <<= 1;
+
+        void* _chBlock = std::realloc(*block, newReserved * elementSize);
+        if (!_chBlock)
+            throw std::bad_alloc();
+        *block = _chBlock;
+        *reserved = newReserved;
+    }
+}
 
-                // set next pointer (from vault size)
-                delta += static_cast<std::uint32_t>(*alpha >> 32); // high (bytes)
+// Reserve elements in vault
+method jvariant just_storage_reserve_vault(just_storage* pstore, JustType type, jnumber count)
+{
+    int index = static_cast<int>(type) - 1;
+    if (pstore->arena && count > pstore->reserved[index])
+        throw std::length_error("arena is overflow");
+    just_storage_grow(&pstore->vault[index], &pstore->reserved[index], count, just_type_size(type), 16);
+    return pstore->vault[index];
+}
 
-                ++type;
-            }
-        } else {
+// Reserve characters in string pool
+method char* just_storage_reserve_pool(just_storage* pstore, jnumber size)
+{
+    if (just_storage_in_arena(pstore, pstore->pool) && size > pstore->poolReserved)
+        throw std::length_error("arena is overflow");
+    just_storage_grow(reinterpret_cast<void**>(&pstore->pool), &pstore->poolReserved, size, sizeof(char), 256);
+    return pstore->pool;
+}
+
+// Reserve nodes for the trees
+method jnode_t* just_storage_reserve_nodes(just_storage* pstore, jnumber count)
+{
+    if (pstore->arena && count > pstore->nodesReserved)
+        throw std::length_error("arena is overflow");
+    just_storage_grow(reinterpret_cast<void**>(&pstore->nodes), &pstore->nodesReserved, count, sizeof(jnode_t), 16);
+    return pstore->nodes;
+}
+
+// method for align size of the region
+method inline jnumber just_storage_align(jnumber size)
+{
+    const jnumber alignment = alignof(std::max_align_t);
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+// Move regions to one block (arena) in vault order: bools, numbers, reals, strings, trees, nodes, pool.
+// counts - elements of the vaults, withPool - pool is placed in arena, otherwise it is separated block
+// When the storage has arena already, regions is compacted to new arena and previous is released.
+method void just_storage_arena(just_storage* pstore, const jnumber* counts, jnumber numNodes, jnumber poolBytes, bool withPool)
+{
+    int x;
+    char* arena;
+    jnumber offsets[8];
+    jnumber sizes[7];
+
+    // calc regions (see. just_stats::calcBytes), aligned
+    for (x = 0; x < 5; ++x)
+        sizes[x] = counts[x] * just_type_size(static_cast<JustType>(x + 1));
+    sizes[5] = numNodes * sizeof(jnode_t);
+    sizes[6] = withPool ? poolBytes : 0;
+
+    offsets[0] = 0;
+    for (x = 0; x < 7; ++x)
+        offsets[x + 1] = offsets[x] + just_storage_align(sizes[x]);
+
+    if (!(arena = static_cast<char*>(std::malloc(offsets[7] ? offsets[7] : 1))))
+        throw std::bad_alloc();
+
+    // move regions
+    for (x = 0; x < 5; ++x) {
+        if ((&pstore->numBools)[x])
+            std::memcpy(arena + offsets[x], pstore->vault[x], (&pstore->numBools)[x] * just_type_size(static_cast<JustType>(x + 1)));
+        if (!just_storage_in_arena(pstore, pstore->vault[x]))
+            std::free(pstore->vault[x]);
+        pstore->vault[x] = arena + offsets[x];
+        pstore->reserved[x] = counts[x];
+    }
+    if (pstore->numNodes)
+        std::memcpy(arena + offsets[5], pstore->nodes, pstore->numNodes * sizeof(jnode_t));
+    if (!just_storage_in_arena(pstore, pstore->nodes))
+        std::free(pstore->nodes);
+    pstore->nodes = reinterpret_cast<jnode_t*>(arena + offsets[5]);
+    pstore->nodesReserved = numNodes;
+
+    if (withPool) {
+        if (pstore->poolSize)
+            std::memcpy(arena + offsets[6], pstore->pool, pstore->poolSize);
+        if (!just_storage_in_arena(pstore, pstore->pool))
+            std::free(pstore->pool);
+        pstore->pool = arena + offsets[6];
+        pstore->poolReserved = poolBytes;
+    }
 
-            for (; pointer < delta; ++alpha) {
+    std::free(pstore->arena);
+    pstore->arena = arena;
+    pstore->arenaSize = offsets[7];
+}
+
+// Reserve storage from statistics (see. just_avail), all regions in one arena, after it the storage is not realloc
+method void just_storage_reserve(just_storage* pstore, const just_stats& jstat)
+{
+    const jnumber counts[] { jstat.jbools, jstat.jnumbers, jstat.jreals, jstat.jstrings, jstat.jtrees };
+    // borrowed strings is not required pool, escaped strings only (separated block)
+    just_storage_arena(pstore, counts, jstat.jnodes, jstat.jstrings_total_bytes, pstore->source == nullptr);
+}
 
-                std::uint32_t size = just_storage_get_vault_info(pstorage, static_cast<JustType>(type));
+// Set borrowed source, strings without escape sequence can refer to it
+method void just_storage_borrow(just_storage* pstore, const char* source, jnumber length)
+{
+    pstore->source = source;
+    pstore->sourceLength = length;
+}
 
-                // set next pointer (from vault size)
-                delta += static_cast<std::uint32_t>(*alpha >> 32); // high (bytes)
+// Get characters of the string field
+method const char* just_storage_get_chars(const just_storage* pstore, const just_string_t* str)
+{
+    return (str->flags & String_BorrowedFlag ? pstore->source : pstore->pool) + str->offset;
+}
 
-                ++type;
+// method for get type from pointer (storage required)
+method JustType just_storage_get_type(const just_storage* pstorage, const void* pointer)
+{
+    int type;
+    if (pointer) {
+        const char* delta = static_cast<const char*>(pointer);
+        if (pstorage->optimized) {
+            // regions in a row: count of the region starts before pointer
+            const char* const* vault = reinterpret_cast<const char* const*>(pstorage->vault);
+            if (delta >= vault[0] && delta < vault[4] + pstorage->numTrees * sizeof(jtree_t))
+                type = 1 + (delta >= vault[1]) + (delta >= vault[2]) + (delta >= vault[3]) + (delta >= vault[4]);
+            else
+                type = static_cast<int>(JustType::Unknown);
+        } else {
+            for (type = static_cast<int>(JustType::JustBoolean); type <= static_cast<int>(JustType::JustTree); ++type) {
+                const char* region = static_cast<const char*>(pstorage->vault[type - 1]);
+                // pointer in region
+                if (delta >= region && delta < region + (&pstorage->numBools)[type - 1] * just_type_size(static_cast<JustType>(type)))
+                    break;
             }
+            if (type > static_cast<int>(JustType::JustTree))
+                // ops: pointer is not from storage
+                type = static_cast<int>(JustType::Unknown);
         }
     } else
         // ops: Type is null, var is empty
@@ -318,78 +810,88 @@ method jvariant just_storage_alloc_field(just_storage** pstore, JustType type, i
         throw std::runtime_error("storage has optimized state");
     }
 
-    // Storage Meta-info
-    // Low bytes: count
-    // High bytes: size
-    // Check
     jvariant _vault;
+    jnumber* counter;
 
-    _vault = just_storage_get_vault(*pstore, type);
+    if (type < JustType::JustBoolean || type > JustType::JustTree)
+        // value is null
+        return nullptr;
 
-    // value is null
-    if (!_vault)
-        return _vault;
+    counter = &(*pstore)->numBools + (static_cast<int>(type) - 1);
+    _vault = just_storage_reserve_vault(*pstore, type, *counter + 1);
+    _vault = static_cast<char*>(_vault) + (*counter)++ * just_type_size(type);
+    std::memset(_vault, 0, just_type_size(type));
+
+    if (type == JustType::JustString) {
+        // string field, characters in pool
+        just_string_t* str = static_cast<just_string_t*>(_vault);
+        if (size < 0)
+            size = 0;
+        just_storage_reserve_pool(*pstore, (*pstore)->poolSize + size + 1);
+        str->offset = (*pstore)->poolSize;
+        str->length = size;
+        str->flags = String_PoolFlag;
+        _vault = (*pstore)->pool + (*pstore)->poolSize;
+        // null-terminated
+        static_cast<char*>(_vault)[size] = '\0';
+        (*pstore)->poolSize += size + 1;
+    }
 
-    if (type == JustType::JustTree) { // can be realloc ?
-        // for tree
-        _vault = new jtree_t;
-        ++(*pstore)->numTrees;
-    } else { // for primary types
+    return _vault;
+}
 
-        if (size <= 0) {
-            if (type == JustType::JustString) {
-                // Error. String size is empty
-                return nullptr;
-            }
-            size = just_type_size(type);
-        }
+// Create string field refer to borrowed source (without copy)
+method just_string_t* just_storage_alloc_string_ref(just_storage** pstore, const char* chars, int length)
+{
+    just_string_t* str;
+    if (pstore == nullptr || *pstore == nullptr)
+        throw std::bad_alloc();
 
-        // vault after changed
-        jvariant _chVault = std::realloc(_vault, size);
-        if (_chVault) {
-            // set as zero
-            std::memset(_chVault, 0, size);
+    if ((*pstore)->optimized)
+        throw std::runtime_error("storage has optimized state");
 
-            switch (type) {
-            case JustType::JustBoolean:
-                ++(*pstore)->numBools;
-            case JustType::JustNumber:
-                ++(*pstore)->numNumbers;
-            case JustType::JustReal:
-                ++(*pstore)->numReals;
-            case JustType::JustString:
-                ++(*pstore)->numStrings;
-            default:
-                throw std::bad_cast();
-            }
-        }
-        _vault = _chVault;
-    }
+    if ((*pstore)->source == nullptr || chars < (*pstore)->source || chars + length > (*pstore)->source + (*pstore)->sourceLength)
+        throw std::out_of_range("string is not in borrowed source");
 
-    return _vault;
+    str = static_cast<just_string_t*>(just_storage_reserve_vault(*pstore, JustType::JustString, (*pstore)->numStrings + 1));
+    str += (*pstore)->numStrings++;
+    str->offset = static_cast<std::uint64_t>(chars - (*pstore)->source);
+    str->length = length;
+    str->flags = String_BorrowedFlag;
+    return str;
 }
 
 // Method for get Pointer to Internal Pointer (IPT). Lowest at pointer
 method int just_storage_get_ipt(const just_storage* pstore, const jvariant pointer)
 {
-    int ipt = 0; // Internal Pointer
-    if (pstore->optimized) {
-        // TODO: OPTIMIZED STATE
-        throw std::exception();
-    } else {
-        // pstore->vault
-        // const jvariant index = pstorage->vault;
-        JustType type = just_storage_get_type(pstore, pointer);
-    }
+    int ipt; // Internal Pointer
+    JustType type = just_storage_get_type(pstore, pointer);
+    if (type > JustType::Null) {
+        jnumber index = (static_cast<const char*>(pointer) - static_cast<const char*>(pstore->vault[static_cast<int>(type) - 1])) / just_type_size(type);
+        ipt = just_ipt_make(type, index);
+    } else
+        ipt = Invalid_IPT;
     return ipt;
 }
+
+// Method from Internal Pointer (IPT) to Pointer of the known type (type is not Null)
+method inline jvariant just_storage_get_field(const just_storage* pstore, const JustType type, const int ipt)
+{
+    return static_cast<char*>(pstore->vault[static_cast<int>(type) - 1]) + static_cast<jnumber>(just_ipt_index(ipt)) * just_type_size(type);
+}
+
 // Method from Internal Pointer (IPT) to Pointer. Lowest at pointer
-method jvariant just_storage_get_pointer(const just_storage* pstore, const int ipt) { return nullptr; }
-// Create Tree
-method jtree_t* just_storage_alloc_tree(just_storage** pstore, jtree_t* owner = nullptr)
+method jvariant just_storage_get_pointer(const just_storage* pstore, const int ipt)
+{
+    JustType type = just_ipt_type(ipt);
+    if (type < JustType::JustBoolean)
+        return nullptr;
+    return just_storage_get_field(pstore, type, ipt);
+}
+
+// Create Tree, nodes is commited on close (see. just_storage_commit_tree)
+method int just_storage_alloc_tree(just_storage** pstore)
 {
-    int ipt;
-    jtree_t* pjtree;
     if (pstore == nullptr || *pstore == nullptr)
         throw std::bad_alloc();
 
@@ -397,914 +899,3682 @@ method jtree_t* just_storage_alloc_tree(just_storage** pstore, jtree_t* owner =
         throw std::runtime_error("storage in optimized state");
     }
 
-    pjtree = static_cast<jtree_t*>(just_storage_alloc_field(pstore, JustType::JustTree));
-
-    if (owner != nullptr) {
-        ipt = just_storage_get_ipt(*pstore, pjtree);
-        owner->emplace_back(ipt);
+    just_storage_alloc_field(pstore, JustType::JustTree);
+    if ((*pstore)->lazy) {
+        // tree is not pending (see. just_storage_materialize)
+        just_storage_grow(reinterpret_cast<void**>(&(*pstore)->lazy), &(*pstore)->lazyReserved, (*pstore)->numTrees, sizeof(just_lazy_block), 64);
+        (*pstore)->lazy[(*pstore)->numTrees - 1] = {};
     }
+    if ((*pstore)->rows) {
+        // row is empty (see. just_storage_thaw)
+        just_storage_grow(reinterpret_cast<void**>(&(*pstore)->rows), &(*pstore)->rowsReserved, (*pstore)->numTrees, sizeof(just_row), 64);
+        (*pstore)->rows[(*pstore)->numTrees - 1] = Row_Empty;
+    }
+    return just_ipt_make(JustType::JustTree, (*pstore)->numTrees - 1);
+}
 
-    return pjtree;
+// Commit nodes of the Tree in a row
+method void just_storage_commit_tree(just_storage** pstore, int ipt, const jnode_t* nodes, int length)
+{
+    jtree_t* pjtree;
+    just_storage_reserve_nodes(*pstore, (*pstore)->numNodes + length);
+
+    pjtree = static_cast<jtree_t*>(just_storage_get_pointer(*pstore, ipt));
+    pjtree->offset = static_cast<std::uint32_t>((*pstore)->numNodes);
+    pjtree->length = static_cast<std::uint32_t>(length);
+    if (length)
+        std::memcpy((*pstore)->nodes + (*pstore)->numNodes, nodes, length * sizeof(jnode_t));
+    (*pstore)->numNodes += length;
+    if ((*pstore)->rows) {
+        (*pstore)->rows[just_ipt_index(ipt)].capacity = static_cast<std::uint32_t>(length);
+        just_storage_link_row(*pstore, ipt);
+    }
 }
 
-// Create Array Node
-method jvariant just_storage_alloc_array(just_storage** pstore, JustType arrayType)
+// Get hash of the node name
+method inline std::uint64_t just_node_name_hash(const just_storage* pstore, const jnode_t* pnode)
 {
-    jvariant variant;
+    const just_string_t* str;
+    if (pstore->hashes)
+        return pstore->hashes[just_ipt_index(pnode->name)];
+    str = static_cast<const just_string_t*>(just_storage_get_pointer(pstore, pnode->name));
+    return just_string_hash(just_storage_get_chars(pstore, str), str->length);
+}
 
-    return variant;
+// Slots of the tree index (power of two, load factor 0.5), zero is not indexed
+method inline jnumber just_index_capacity(std::uint32_t length)
+{
+    jnumber capacity = 1;
+    if (length < Index_MinLength)
+        return 0;
+    while (capacity < static_cast<jnumber>(length) * 2)
+        capacity <<= 1;
+    return capacity;
 }
 
-// Optimize storage (ordering and compress)
-method bool just_storage_optimize(just_storage** pstore)
+// Find node in the index, name is interned string (IPT)
+method const jnode_t* just_index_find(const just_storage* pstore, const just_index_slot* slots, jnumber capacity, std::uint64_t hash, int name)
 {
-    if ((*pstore)->optimized)
-        return true;
+    const std::uint32_t tag = static_cast<std::uint32_t>(hash >> 32);
+    for (jnumber x = hash & (capacity - 1);; x = (x + 1) & (capacity - 1)) {
+        if (slots[x].node == Index_Empty)
+            return nullptr;
+        if (slots[x].tag == tag && pstore->nodes[slots[x].node].name == name)
+            return pstore->nodes + slots[x].node;
+    }
+}
 
-    // TODO: optimize here
-    return false;
+// Insert node to the index, first node with the name is kept
+method void just_index_insert(const just_storage* pstore, just_index_slot* slots, jnumber capacity, std::uint64_t hash, std::uint32_t node)
+{
+    const std::uint32_t tag = static_cast<std::uint32_t>(hash >> 32);
+    for (jnumber x = hash & (capacity - 1);; x = (x + 1) & (capacity - 1)) {
+        if (slots[x].node == Index_Empty) {
+            slots[x].node = node;
+            slots[x].tag = tag;
+            return;
+        }
+        if (slots[x].tag == tag && pstore->nodes[slots[x].node].name == pstore->nodes[node].name)
+            return;
+    }
 }
 
-// method for fast get hash from string
-method inline int just_string_to_hash_fast(const char* char_side, int contentLength = INT32_MAX)
+// Grow table of the interned strings (load factor 0.5), position from tag (low bits of the hash)
+method void just_storage_grow_intern(just_storage* pstore)
 {
-    int x = 1, y = 0;
-    while (*(char_side) && y++ < contentLength)
-        x *= *(char_side++);
-    return x;
+    jnumber x, y, capacity = pstore->internCapacity ? pstore->internCapacity << 1 : 256;
+    just_index_slot* slots = static_cast<just_index_slot*>(std::malloc(capacity * sizeof(just_index_slot)));
+    if (!slots)
+        throw std::bad_alloc();
+    std::memset(slots, 0xFF, capacity * sizeof(just_index_slot));
+    for (x = 0; x < pstore->internCapacity; ++x) {
+        if (pstore->intern[x].node == Index_Empty)
+            continue;
+        for (y = pstore->intern[x].tag & (capacity - 1); slots[y].node != Index_Empty; y = (y + 1) & (capacity - 1))
+            ;
+        slots[y] = pstore->intern[x];
+    }
+    std::free(pstore->intern);
+    pstore->intern = slots;
+    pstore->internCapacity = capacity;
 }
 
-// method for check valid a unsigned number
-method inline bool just_is_unsigned_jnumber(const char char_side) { return std::isdigit(char_side); }
+// Find interned string by content, Invalid_IPT: string is not stored
+method int just_storage_find_string(const just_storage* pstore, const char* chars, int length, std::uint64_t hash)
+{
+    const std::uint32_t tag = static_cast<std::uint32_t>(hash);
+    const just_string_t* strings = static_cast<const just_string_t*>(pstore->vault[static_cast<int>(JustType::JustString) - 1]);
+
+    if (!pstore->internCapacity)
+        return Invalid_IPT;
+    for (jnumber x = tag & (pstore->internCapacity - 1);; x = (x + 1) & (pstore->internCapacity - 1)) {
+        const just_index_slot& slot = pstore->intern[x];
+        if (slot.node == Index_Empty)
+            return Invalid_IPT;
+        if (slot.tag == tag && static_cast<int>(strings[slot.node].length) == length && !std::memcmp(just_storage_get_chars(pstore, strings + slot.node), chars, length))
+            return just_ipt_make(JustType::JustString, slot.node);
+    }
+}
 
-// method for check valid a signed number
-method inline bool just_is_jnumber(const char* char_side, int* getLength)
+// Intern the last string field: duplicate is released (last in vault and pool), returns IPT of the stored string.
+// hash: hash of the string is known (zero - is calculated)
+method int just_storage_intern(just_storage* pstore, std::uint64_t hash)
 {
+    jnumber last = pstore->numStrings - 1;
+    just_string_t* str = static_cast<just_string_t*>(pstore->vault[static_cast<int>(JustType::JustString) - 1]) + last;
+    const char* chars = just_storage_get_chars(pstore, str);
+    int ipt;
 
-    int x = 0;
-    if (*char_side == just_syntax.just_negative_sym) {
-        ++x;
-        ++char_side;
-    }
-    const char* pointer = char_side;
-    for (; just_is_unsigned_jnumber(*pointer); ++x, ++pointer) { }
-    if (getLength) {
-        *getLength = x;
+    if (!hash)
+        hash = just_string_hash(chars, str->length);
+    ipt = just_storage_find_string(pstore, chars, str->length, hash);
+
+    if (ipt != Invalid_IPT) {
+        if (!(str->flags & String_BorrowedFlag))
+            pstore->poolSize -= str->length + 1;
+        --pstore->numStrings;
+        ++pstore->internHits;
+        return ipt;
     }
 
-    return pointer - char_side > 0;
+    if (pstore->numStrings * 2 > pstore->internCapacity)
+        just_storage_grow_intern(pstore);
+    jnumber x = static_cast<std::uint32_t>(hash) & (pstore->internCapacity - 1);
+    while (pstore->intern[x].node != Index_Empty)
+        x = (x + 1) & (pstore->internCapacity - 1);
+    pstore->intern[x].node = static_cast<std::uint32_t>(last);
+    pstore->intern[x].tag = static_cast<std::uint32_t>(hash);
+    just_storage_grow(reinterpret_cast<void**>(&pstore->hashes), &pstore->hashesReserved, pstore->numStrings, sizeof(std::uint64_t), 256);
+    pstore->hashes[last] = hash;
+    return just_ipt_make(JustType::JustString, last);
 }
 
-// method for check is real ?
-method jbool just_is_jreal(const char* char_side, int* getLength)
+// Build names index of the trees, storage is not changed after it
+method void just_storage_build_index(just_storage* pstore)
 {
-    bool real = false;
-    for (;;) {
-        if (!just_is_unsigned_jnumber(char_side[*getLength])) {
-            if (real)
-                break;
+    jnumber x, slots = 0;
+    const jtree_t* pjtree;
+    const jtree_t* pjtrees = static_cast<const jtree_t*>(pstore->vault[static_cast<int>(JustType::JustTree) - 1]);
 
-            real = (char_side[*getLength] == just_syntax.just_dot);
+    if (pstore->index || !pstore->numTrees)
+        return;
 
-            if (!real)
-                break;
-        }
-        ++*getLength;
+    // calc slots
+    if (!(pstore->indexTables = static_cast<jnumber*>(std::malloc(pstore->numTrees * sizeof(jnumber)))))
+        throw std::bad_alloc();
+    for (x = 0; x < pstore->numTrees; ++x) {
+        pjtree = pjtrees + x;
+        // arrays is not named
+        if (pjtree->length && pstore->nodes[pjtree->offset].name != Invalid_IPT) {
+            pstore->indexTables[x] = slots;
+            slots += just_index_capacity(pjtree->length);
+        } else
+            pstore->indexTables[x] = -1;
+    }
+
+    if (!(pstore->index = static_cast<just_index_slot*>(std::malloc((slots ? slots : 1) * sizeof(just_index_slot)))))
+        throw std::bad_alloc();
+    std::memset(pstore->index, 0xFF, slots * sizeof(just_index_slot));
+    pstore->indexSize = slots;
+    pstore->indexReserved = slots;
+    pstore->indexTrees = pstore->indexTablesReserved = pstore->numTrees;
+
+    for (x = 0; x < pstore->numTrees; ++x) {
+        jnumber capacity;
+        pjtree = pjtrees + x;
+        if (pstore->indexTables[x] < 0 || !(capacity = just_index_capacity(pjtree->length)))
+            continue;
+        for (std::uint32_t node = pjtree->offset; node < pjtree->offset + pjtree->length; ++node)
+            if (pstore->nodes[node].name != Invalid_IPT)
+                just_index_insert(pstore, pstore->index + pstore->indexTables[x], capacity, just_node_name_hash(pstore, pstore->nodes + node), node);
     }
-    return real;
 }
 
-// method for check is bool ?
-method inline jbool just_is_jbool(const char* char_side, int* getLength)
+// Index names of the tree parsed later (lazy document), slots of the tree is appended to index.
+// Tables of the new trees (pending or arrays) is empty.
+method void just_storage_index_tree(just_storage* pstore, int tree)
 {
-    if (!std::memcmp(char_side, just_syntax.just_true_string, *getLength = sizeof(just_syntax.just_true_string) - 1))
-        return true;
-    if (!std::memcmp(char_side, just_syntax.just_false_string, *getLength = sizeof(just_syntax.just_false_string) - 1))
-        return true;
-    *getLength = 0;
-    return false;
+    jnumber x = just_ipt_index(tree), capacity;
+    const jtree_t* pjtree = static_cast<const jtree_t*>(just_storage_get_pointer(pstore, tree));
+
+    just_storage_grow(reinterpret_cast<void**>(&pstore->indexTables), &pstore->indexTablesReserved, pstore->numTrees, sizeof(jnumber), 64);
+    for (; pstore->indexTrees < pstore->numTrees; ++pstore->indexTrees)
+        pstore->indexTables[pstore->indexTrees] = -1;
+
+    // arrays is not named
+    if (!(capacity = just_index_capacity(pjtree->length)) || pstore->nodes[pjtree->offset].name == Invalid_IPT)
+        return;
+    just_storage_grow(reinterpret_cast<void**>(&pstore->index), &pstore->indexReserved, pstore->indexSize + capacity, sizeof(just_index_slot), 256);
+    std::memset(pstore->index + pstore->indexSize, 0xFF, capacity * sizeof(just_index_slot));
+    pstore->indexTables[x] = pstore->indexSize;
+    pstore->indexSize += capacity;
+    for (std::uint32_t node = pjtree->offset; node < pjtree->offset + pjtree->length; ++node)
+        if (pstore->nodes[node].name != Invalid_IPT)
+            just_index_insert(pstore, pstore->index + pstore->indexTables[x], capacity, just_node_name_hash(pstore, pstore->nodes + node), node);
 }
 
-// method for get format from raw content, also to write in storage pointer
-method int just_get_format(const char* char_side, just_storage** storage, JustType& containType, jvariant* outValue = nullptr)
+// Copy of the region to own block (binary image or arena is not released by it)
+method void* just_storage_copy_region(const void* block, jnumber size)
 {
-    /*
-         * Priority:
-         *  - JReal
-         *  - JNumber
-         *  - JBool
-         *  - JString
-         */
+    void* copy = std::malloc(size ? size : 1);
+    if (!copy)
+        throw std::bad_alloc();
+    if (size)
+        std::memcpy(copy, block, size);
+    return copy;
+}
 
-    void* mem;
-    int offset = 0;
+// Storage for edit (mutable document): regions is separated from arena (or binary image), trees has rows with capacity.
+// Storage is not optimized after it (see. just_storage_optimize), optimize again is compact it.
+method void just_storage_thaw(just_storage* pstore)
+{
+    int x;
+    const jtree_t* pjtrees;
 
-    // Null type
-    if (char_side == nullptr || *char_side == '\0') {
-        containType = JustType::Null;
-    } else if (just_is_jreal(char_side, &offset)) { // Real type -----------------------------------------------------------------------------
-        containType = JustType::JustReal;
-        if (storage) {
-            jreal conv = std::atof(char_side); // use "C++" method
-            // Copy to
-            mem = std::memcpy(just_storage_alloc_field(storage, containType), &conv, just_type_size(containType));
-            if (outValue)
-                *outValue = mem;
+    if (pstore->rows)
+        return;
+
+    if (pstore->external || pstore->arena) {
+        for (x = 0; x < 5; ++x) {
+            pstore->vault[x] = just_storage_copy_region(pstore->vault[x], (&pstore->numBools)[x] * just_type_size(static_cast<JustType>(x + 1)));
+            pstore->reserved[x] = (&pstore->numBools)[x];
         }
-    } else if (just_is_jnumber(char_side, &offset)) { // Number type ---------------------------------------------------------------------------------
-        jnumber conv;
-        containType = JustType::JustNumber;
-        sscanf(char_side, "%lld", &conv); // use "C" method
-        if (storage) {
-            // Copy to
-            mem = std::memcpy(just_storage_alloc_field(storage, containType), &conv, just_type_size(containType));
-            if (outValue)
-                *outValue = mem;
+        pstore->nodes = static_cast<jnode_t*>(just_storage_copy_region(pstore->nodes, pstore->numNodes * sizeof(jnode_t)));
+        pstore->nodesReserved = pstore->numNodes;
+        // pool is separated block (borrowed source)
+        if (pstore->external || just_storage_in_arena(pstore, pstore->pool)) {
+            pstore->pool = static_cast<char*>(just_storage_copy_region(pstore->pool, pstore->poolSize));
+            pstore->poolReserved = pstore->poolSize;
         }
-    } else if (just_is_jbool(char_side, &offset)) { // Bool type -----------------------------------------------------------------------------
-        containType = JustType::JustBoolean;
-        if (storage) {
-            jbool conv = (offset == sizeof(just_syntax.just_true_string) - 1);
-            // Copy to
-            mem = std::memcpy(just_storage_alloc_field(storage, containType), &conv, just_type_size(containType));
-            if (outValue)
-                *outValue = mem;
+    }
+    if (pstore->external) {
+        // index and interned strings of the image
+        pstore->index = static_cast<just_index_slot*>(just_storage_copy_region(pstore->index, pstore->indexSize * sizeof(just_index_slot)));
+        pstore->indexTables = static_cast<jnumber*>(just_storage_copy_region(pstore->indexTables, pstore->numTrees * sizeof(jnumber)));
+        pstore->intern = static_cast<just_index_slot*>(just_storage_copy_region(pstore->intern, pstore->internCapacity * sizeof(just_index_slot)));
+        pstore->indexReserved = pstore->indexSize;
+        pstore->indexTrees = pstore->indexTablesReserved = pstore->numTrees;
+        pstore->external = false;
+    } else
+        std::free(pstore->arena);
+    pstore->arena = nullptr;
+    pstore->arenaSize = 0;
+    pstore->optimized = false;
+
+    // hash per stored string for new strings (see. just_storage_intern)
+    if (!pstore->hashes && pstore->numStrings) {
+        just_storage_grow(reinterpret_cast<void**>(&pstore->hashes), &pstore->hashesReserved, pstore->numStrings, sizeof(std::uint64_t), 256);
+        for (jnumber y = 0; y < pstore->numStrings; ++y) {
+            const just_string_t* str = static_cast<const just_string_t*>(pstore->vault[static_cast<int>(JustType::JustString) - 1]) + y;
+            pstore->hashes[y] = just_string_hash(just_storage_get_chars(pstore, str), str->length);
         }
-    } else if (*char_side == just_syntax.just_format_string) { // String type ----------------------------------------------------------------
-        ++offset;
-        for (; char_side[offset] != just_syntax.just_format_string; ++offset)
-            if (char_side[offset] == just_syntax.just_left_seperator && char_side[offset + 1] == just_syntax.just_format_string)
-                ++offset;
-        containType = JustType::JustString;
-        if (--offset) {
-            if (storage) {
-                // TODO: Go support next for string. '\n' '\r' .etc.
-                jstring stringSyntax;
-                stringSyntax.reserve(offset);
-                for (int x = 0; x < offset; ++x) {
-                    if (char_side[x + 1] == just_syntax.just_left_seperator)
-                        ++x;
-                    stringSyntax.push_back(char_side[x + 1]);
-                }
+    }
 
-                // Copy to
-                mem = std::memcpy(just_storage_alloc_field(storage, containType, stringSyntax.size()), stringSyntax.data(), stringSyntax.size());
-                if (outValue)
-                    *outValue = mem;
-            }
-        }
-        offset += 2;
-    } else // another type
-        containType = JustType::Unknown;
+    // parsed rows is full, trees is not serialized
+    just_storage_grow(reinterpret_cast<void**>(&pstore->rows), &pstore->rowsReserved, std::max<jnumber>(pstore->numTrees, 1), sizeof(just_row), 64);
+    pjtrees = static_cast<const jtree_t*>(pstore->vault[static_cast<int>(JustType::JustTree) - 1]);
+    for (jnumber y = 0; y < pstore->numTrees; ++y) {
+        pstore->rows[y] = Row_Empty;
+        pstore->rows[y].capacity = pjtrees[y].length;
+    }
+    for (jnumber y = 0; y < pstore->numTrees; ++y)
+        just_storage_link_row(pstore, just_ipt_make(JustType::JustTree, y));
+    for (x = 0; x < 32; ++x)
+        pstore->freeRows[x] = -1;
+}
 
+// Owner of the nodes in row of the tree, parent of the subtrees
+method void just_storage_link_row(just_storage* pstore, int tree)
+{
+    std::uint32_t x = static_cast<std::uint32_t>(just_ipt_index(tree));
+    const jtree_t* pjtree = static_cast<const jtree_t*>(just_storage_get_pointer(pstore, tree));
+    const std::uint32_t capacity = pstore->rows[x].capacity;
+
+    just_storage_grow(reinterpret_cast<void**>(&pstore->owners), &pstore->ownersReserved, std::max<jnumber>(pstore->numNodes, pjtree->offset + capacity), sizeof(std::uint32_t), 256);
+    for (std::uint32_t node = pjtree->offset; node < pjtree->offset + capacity; ++node)
+        pstore->owners[node] = x;
+    for (std::uint32_t node = pjtree->offset; node < pjtree->offset + pjtree->length; ++node)
+        if (just_ipt_type(pstore->nodes[node].value) == JustType::JustTree)
+            pstore->rows[just_ipt_index(pstore->nodes[node].value)].parent = static_cast<int>(x);
+}
+
+// Tree is edited: the tree and parents is serialized again (see. just_serialize_edited), dirty parent is stop
+method void just_storage_touch(just_storage* pstore, int tree)
+{
+    for (int x = just_ipt_index(tree); x >= 0 && !pstore->rows[x].dirty; x = pstore->rows[x].parent)
+        pstore->rows[x].dirty = 1;
+}
+
+// Release row of the nodes to free-list, size of the row is power of two (tail of the parsed row is not used)
+method void just_storage_free_row(just_storage* pstore, std::uint32_t offset, std::uint32_t capacity)
+{
+    int size;
+    if (!capacity)
+        return;
+    for (size = 0; (2u << size) <= capacity; ++size)
+        ;
+    // next released row in first node
+    pstore->nodes[offset].name = pstore->freeRows[size];
+    pstore->freeRows[size] = static_cast<int>(offset);
+}
+
+// Row of the nodes (1 << size) from free-list, otherwise at end of the nodes. Nodes of the row is empty
+method std::uint32_t just_storage_alloc_row(just_storage* pstore, int size)
+{
+    std::uint32_t offset;
+    if (pstore->freeRows[size] >= 0) {
+        offset = static_cast<std::uint32_t>(pstore->freeRows[size]);
+        pstore->freeRows[size] = pstore->nodes[offset].name;
+    } else {
+        just_storage_reserve_nodes(pstore, pstore->numNodes + (1 << size));
+        offset = static_cast<std::uint32_t>(pstore->numNodes);
+        pstore->numNodes += 1 << size;
+    }
+    std::memset(pstore->nodes + offset, 0xFF, (1 << size) * sizeof(jnode_t));
     return offset;
 }
 
-// method for check. has type in value
-method inline jbool just_has_datatype(const char* char_side)
+// Row of the tree for length nodes, it is moved to row of the power of two on grow.
+// returns true: row is moved (numbers of the nodes is changed)
+method bool just_storage_reserve_row(just_storage* pstore, int tree, std::uint32_t length)
 {
-    JustType type;
-    just_get_format(const_cast<char*>(char_side), nullptr, type);
-    return type > JustType::Null;
+    int size;
+    std::uint32_t offset;
+    jtree_t* pjtree;
+    just_row* row = pstore->rows + just_ipt_index(tree);
+
+    if (length <= row->capacity)
+        return false;
+    for (size = 2; (1u << size) < length; ++size)
+        ;
+    offset = just_storage_alloc_row(pstore, size);
+    pjtree = static_cast<jtree_t*>(just_storage_get_pointer(pstore, tree));
+    if (pjtree->length)
+        std::memcpy(pstore->nodes + offset, pstore->nodes + pjtree->offset, pjtree->length * sizeof(jnode_t));
+    just_storage_free_row(pstore, pjtree->offset, row->capacity);
+    pjtree->offset = offset;
+    row->capacity = 1u << size;
+    just_storage_link_row(pstore, tree);
+    return true;
 }
 
-// method for trim tabs, space, EOL (etc) to skip.
-method int just_trim(const char* char_side, int contentLength = INT_MAX)
+// Index names of the edited tree again: table of the same capacity is cleared, otherwise new table is appended (previous is not used)
+method void just_storage_reindex_tree(just_storage* pstore, int tree, std::uint32_t previous)
 {
-    int x = 0;
-    if (char_side != nullptr)
-        for (int y; x < contentLength && *char_side;) {
-            for (y = 0; y < static_cast<int>(sizeof(just_syntax.just_trim_segments));)
-                if (*char_side == just_syntax.just_trim_segments[y])
-                    break;
-                else
-                    ++y;
-            if (y != sizeof(just_syntax.just_trim_segments)) {
-                ++x;
-                ++char_side;
-            } else
-                break;
+    jnumber x = just_ipt_index(tree), capacity;
+    const jtree_t* pjtree = static_cast<const jtree_t*>(just_storage_get_pointer(pstore, tree));
+
+    if (x < pstore->indexTrees && pstore->indexTables[x] >= 0) {
+        capacity = just_index_capacity(pjtree->length);
+        if (capacity && capacity == just_index_capacity(previous) && pstore->nodes[pjtree->offset].name != Invalid_IPT) {
+            std::memset(pstore->index + pstore->indexTables[x], 0xFF, capacity * sizeof(just_index_slot));
+            for (std::uint32_t node = pjtree->offset; node < pjtree->offset + pjtree->length; ++node)
+                if (pstore->nodes[node].name != Invalid_IPT)
+                    just_index_insert(pstore, pstore->index + pstore->indexTables[x], capacity, just_node_name_hash(pstore, pstore->nodes + node), node);
+            return;
         }
-    return x;
+        pstore->indexTables[x] = -1;
+    }
+    just_storage_index_tree(pstore, tree);
 }
 
-method int just_skip(const char* char_side, int length = INT_MAX)
+// Value in the storage: string is interned, tree is empty. data: value in storage format (characters for string)
+method int just_storage_alloc_value(just_storage* pstore, JustType type, const void* data, std::size_t length)
 {
-    int x, y;
-    char skipping[sizeof(just_syntax.just_trim_segments) + sizeof(just_syntax.just_block_segments)];
-    strncpy(skipping, just_syntax.just_trim_segments, sizeof(just_syntax.just_trim_segments));
-    strncpy(skipping + sizeof just_syntax.just_trim_segments, just_syntax.just_block_segments, sizeof(just_syntax.just_block_segments));
-    for (x = 0; x < length;) {
-        for (y = 0; y < sizeof(skipping);)
-            if (char_side[x] == skipping[y])
-                break;
-            else
-                ++y;
-        if (y == sizeof(skipping))
-            ++x;
-        else
-            break;
+    int ipt;
+    switch (type) {
+    case JustType::JustString:
+        if (length > INT_MAX)
+            throw std::length_error("string is too long");
+        std::memcpy(just_storage_alloc_field(&pstore, type, static_cast<int>(length)), data, length);
+        return just_storage_intern(pstore);
+    case JustType::JustTree:
+        ipt = just_storage_alloc_tree(&pstore);
+        just_storage_commit_tree(&pstore, ipt, nullptr, 0);
+        // table of the new tree (see. just_storage_find_node)
+        just_storage_index_tree(pstore, ipt);
+        return ipt;
+    default:
+        std::memcpy(just_storage_alloc_field(&pstore, type), data, just_type_size(type));
+        return just_ipt_make(type, (&pstore->numBools)[static_cast<int>(type) - 1] - 1);
     }
-    return x;
 }
 
-method inline jbool just_valid_property_name(const char* char_side, int len)
+// Value of the next element of the array (bool, number, real), is not set.
+// Elements of one type is kept in a row of the vault (see. just_storage_get_span): a row with reserve is allocated
+// at end of the vault on grow (previous is not used), otherwise element is allocated alone (array of mixed types)
+method int just_storage_alloc_element(just_storage* pstore, int tree, JustType type)
 {
-    int x;
-    for (x = 0; x < len; ++x, ++char_side)
-        if (!((*char_side >= *just_syntax.just_valid_property_name && *char_side <= just_syntax.just_valid_property_name[1]) || (x && just_is_unsigned_jnumber(*char_side)) || *char_side == just_syntax.just_valid_property_name[2]))
-            return false;
-    return len != 0;
+    jnumber span;
+    jnumber* counter = &pstore->numBools + (static_cast<int>(type) - 1);
+    just_row* row = pstore->rows + just_ipt_index(tree);
+    const jtree_t* pjtree = static_cast<const jtree_t*>(just_storage_get_pointer(pstore, tree));
+
+    if (pjtree->length && !just_storage_get_span(pstore, tree, type, &span)) {
+        just_storage_alloc_field(&pstore, type);
+        // mixed array is not span: last element is not at distance of the length from first (slot is skipped)
+        if (just_ipt_type(pstore->nodes[pjtree->offset].value) == type && *counter - 1 - just_ipt_index(pstore->nodes[pjtree->offset].value) == pjtree->length)
+            just_storage_alloc_field(&pstore, type);
+        return just_ipt_make(type, *counter - 1);
+    }
+    if (pjtree->length && row->values > pjtree->length)
+        return just_ipt_make(type, just_ipt_index(pstore->nodes[pjtree->offset].value) + static_cast<jnumber>(pjtree->length));
+
+    return just_ipt_make(type, just_storage_move_row(pstore, tree, type, std::max<jnumber>(4, pjtree->length * 2)) + pjtree->length);
 }
 
-method inline jbool just_is_comment_line(const char* char_side, int len) { return len > 0 && !std::strncmp(char_side, just_syntax.just_commentLine, std::min(2, len)); }
+// Move values of the array (one type) to a new row with reserve at end of the vault, returns index of the first value
+method jnumber just_storage_move_row(just_storage* pstore, int tree, JustType type, jnumber reserve)
+{
+    jnumber* counter = &pstore->numBools + (static_cast<int>(type) - 1);
+    const jtree_t* pjtree = static_cast<const jtree_t*>(just_storage_get_pointer(pstore, tree));
+    jnode_t* pnode = pstore->nodes + pjtree->offset;
+    const int size = just_type_size(type);
+    char* vault = static_cast<char*>(just_storage_reserve_vault(pstore, type, *counter + reserve));
+    jnumber first = *counter;
+
+    *counter += reserve;
+    for (std::uint32_t x = 0; x < pjtree->length; ++x) {
+        std::memcpy(vault + (first + x) * size, vault + static_cast<jnumber>(just_ipt_index(pnode[x].value)) * size, size);
+        pnode[x].value = just_ipt_make(type, first + x);
+    }
+    pstore->rows[just_ipt_index(tree)].values = static_cast<std::uint32_t>(reserve);
+    return first;
+}
 
-method inline int just_has_eol(const char* pointer, int len = INT_MAX)
+// Type of an element of the array is changed: elements of one type is moved to a new row (span).
+// Mixed array is not span: previous slot of the element is in the row yet, last element is moved out of the row.
+method void just_storage_arrange_row(just_storage* pstore, int tree)
 {
-    const char* chars = pointer;
-    const char* endChars = pointer + len;
-    while (*chars && chars < endChars && *chars != just_syntax.just_eol_segment)
-        ++chars;
-    return static_cast<int>(chars - pointer);
+    const jtree_t* pjtree = static_cast<const jtree_t*>(just_storage_get_pointer(pstore, tree));
+    jnode_t* pnode = pstore->nodes + pjtree->offset;
+    JustType type = just_ipt_type(pnode->value);
+    jnumber span;
+    std::uint64_t last;
+    std::uint32_t x;
+
+    if (type < JustType::JustBoolean || type > JustType::JustReal)
+        return;
+    for (x = 1; x < pjtree->length && just_ipt_type(pnode[x].value) == type; ++x)
+        ;
+    if (x == pjtree->length)
+        just_storage_move_row(pstore, tree, type, std::max<jnumber>(4, pjtree->length * 2));
+    else if (just_storage_get_span(pstore, tree, type, &span)) {
+        // vault can be moved on alloc
+        pnode += pjtree->length - 1;
+        std::memcpy(&last, just_storage_get_pointer(pstore, pnode->value), just_type_size(type));
+        std::memcpy(just_storage_alloc_field(&pstore, type), &last, just_type_size(type));
+        pnode->value = just_ipt_make(type, (&pstore->numBools)[static_cast<int>(type) - 1] - 1);
+        pstore->rows[just_ipt_index(tree)].values = 0;
+    }
 }
 
-// method for skip comment's
-method int just_autoskip_comment(const char* char_side, int len)
+// Add node to the end of the tree, returns number of the node
+method std::uint32_t just_storage_add_node(just_storage* pstore, int tree, int name, int value)
 {
-    int offset;
-    const char* pointer = char_side;
-    pointer += offset = just_trim(pointer, len);
-    while (just_is_comment_line(pointer, len - offset)) {
-        // skip to EOL
-        int skipped;
-        pointer += skipped = just_has_eol(pointer, len - offset);
-        offset += skipped;
-        // trimming
-        pointer += skipped = just_trim(pointer, len - offset);
-        offset += skipped;
+    jnumber x = just_ipt_index(tree), capacity;
+    jtree_t* pjtree = static_cast<jtree_t*>(just_storage_get_pointer(pstore, tree));
+    std::uint32_t previous = pjtree->length, node;
+    bool moved = just_storage_reserve_row(pstore, tree, previous + 1);
+
+    node = pjtree->offset + pjtree->length++;
+    pstore->nodes[node] = { name, value };
+    if (just_ipt_type(value) == JustType::JustTree)
+        pstore->rows[just_ipt_index(value)].parent = static_cast<int>(x);
+    just_storage_touch(pstore, tree);
+    // names index: node is inserted to the table of the same capacity, otherwise table is built again
+    if (!moved && name != Invalid_IPT && x < pstore->indexTrees && pstore->indexTables[x] >= 0 && (capacity = just_index_capacity(pjtree->length)) == just_index_capacity(previous))
+        just_index_insert(pstore, pstore->index + pstore->indexTables[x], capacity, just_node_name_hash(pstore, pstore->nodes + node), node);
+    else
+        just_storage_reindex_tree(pstore, tree, previous);
+    // search index is built again (see. just_storage_build_search)
+    std::free(pstore->searchIndex);
+    pstore->searchIndex = nullptr;
+    return node;
+}
+
+// Remove node of the tree with subtree, nodes after it is moved
+method void just_storage_remove_node(just_storage* pstore, int tree, std::uint32_t node)
+{
+    jtree_t* pjtree = static_cast<jtree_t*>(just_storage_get_pointer(pstore, tree));
+    std::uint32_t previous = pjtree->length;
+
+    if (just_ipt_type(pstore->nodes[node].value) == JustType::JustTree)
+        just_storage_release_tree(pstore, pstore->nodes[node].value);
+    std::memmove(pstore->nodes + node, pstore->nodes + node + 1, (pjtree->offset + pjtree->length - node - 1) * sizeof(jnode_t));
+    --pjtree->length;
+    pstore->nodes[pjtree->offset + pjtree->length] = { Invalid_IPT, Invalid_IPT };
+    just_storage_touch(pstore, tree);
+    just_storage_reindex_tree(pstore, tree, previous);
+    std::free(pstore->searchIndex);
+    pstore->searchIndex = nullptr;
+}
+
+// Release rows of the subtree to free-list, the tree is empty after it (pending tree is not parsed)
+method void just_storage_release_tree(just_storage* pstore, int tree)
+{
+    jnumber x;
+    jtree_t* pjtree;
+    std::vector<int> stack(1, tree);
+
+    while (!stack.empty()) {
+        tree = stack.back();
+        stack.pop_back();
+        x = just_ipt_index(tree);
+        if (x < pstore->indexTrees)
+            pstore->indexTables[x] = -1;
+        if (pstore->lazy && pstore->lazy[x].begin) {
+            pstore->lazy[x].begin = 0;
+            continue;
+        }
+        pjtree = static_cast<jtree_t*>(just_storage_get_pointer(pstore, tree));
+        for (std::uint32_t node = pjtree->offset; node < pjtree->offset + pjtree->length; ++node)
+            if (just_ipt_type(pstore->nodes[node].value) == JustType::JustTree)
+                stack.push_back(pstore->nodes[node].value);
+        just_storage_free_row(pstore, pjtree->offset, pstore->rows[x].capacity);
+        pjtree->offset = 0;
+        pjtree->length = 0;
+        pstore->rows[x] = Row_Empty;
     }
-    return offset;
+    std::free(pstore->searchIndex);
+    pstore->searchIndex = nullptr;
 }
 
-method inline jbool just_is_space(const char char_side)
+// Build names index of the search (first node by wide from root), on first search
+method void just_storage_build_search(just_storage* pstore)
 {
-    const char* left = just_syntax.just_trim_segments;
-    const char* right = left + sizeof(just_syntax.just_trim_segments);
-    for (; left < right; ++left)
-        if (*left == char_side)
-            return true;
-    return false;
+    jnumber x, y, named = 0;
+    int* trees;
+    const jtree_t* pjtree;
+    const jtree_t* pjtrees = static_cast<const jtree_t*>(pstore->vault[static_cast<int>(JustType::JustTree) - 1]);
+
+    if (pstore->searchIndex || !pstore->numTrees)
+        return;
+
+    for (x = 0; x < pstore->numNodes; ++x)
+        named += pstore->nodes[x].name != Invalid_IPT;
+    for (pstore->searchCapacity = 1; pstore->searchCapacity < named * 2;)
+        pstore->searchCapacity <<= 1;
+
+    if (!(trees = static_cast<int*>(std::malloc(pstore->numTrees * sizeof(int)))))
+        throw std::bad_alloc();
+    if (!(pstore->searchIndex = static_cast<just_index_slot*>(std::malloc(pstore->searchCapacity * sizeof(just_index_slot))))) {
+        std::free(trees);
+        throw std::bad_alloc();
+    }
+    std::memset(pstore->searchIndex, 0xFF, pstore->searchCapacity * sizeof(just_index_slot));
+
+    // by wide from root: first name is kept
+    trees[0] = 0;
+    for (x = 0, y = 1; x < y; ++x) {
+        pjtree = pjtrees + trees[x];
+        for (std::uint32_t node = pjtree->offset; node < pjtree->offset + pjtree->length; ++node) {
+            const jnode_t* pnode = pstore->nodes + node;
+            if (pnode->name != Invalid_IPT)
+                just_index_insert(pstore, pstore->searchIndex, pstore->searchCapacity, just_node_name_hash(pstore, pnode), node);
+            if (just_ipt_type(pnode->value) == JustType::JustTree && y < pstore->numTrees)
+                trees[y++] = just_ipt_index(pnode->value);
+        }
+    }
+    std::free(trees);
 }
 
-method jbool just_is_array(const char* char_side, int& endpoint, int contentLength = INT_MAX)
+// Find node from tree by name, hash of the name is calculated when required (zero)
+method const jnode_t* just_storage_find_node(const just_storage* pstore, int tree, const char* name, int length, std::uint64_t hash)
 {
-    jbool result = false;
+    int ipt;
+    jnumber capacity;
+    const jtree_t* pjtree;
+    const jnode_t *pnode, *pend;
 
-    if (*char_side == *just_syntax.just_block_segments) {
-        int x = 1;
-        x += just_autoskip_comment(char_side + x, contentLength - x);
-        if (just_has_datatype(char_side + x) || char_side[x] == just_syntax.just_block_segments[1]) {
-            for (; char_side[x] && x < contentLength; ++x) {
-                if (char_side[x] == just_syntax.just_block_segments[0])
-                    break;
-                else if (char_side[x] == just_syntax.just_block_segments[1]) {
-                    endpoint = x;
-                    result = true;
-                    break;
-                }
+    if (just_ipt_type(tree) != JustType::JustTree)
+        return nullptr;
+
+    // names is interned: compare by IPT, the name is not stored - is not found
+    if (!hash)
+        hash = just_string_hash(name, length);
+    if ((ipt = just_storage_find_string(pstore, name, length, hash)) == Invalid_IPT)
+        return nullptr;
+
+    pjtree = static_cast<const jtree_t*>(just_storage_get_pointer(pstore, tree));
+    if (pstore->index && pstore->indexTables[just_ipt_index(tree)] >= 0 && (capacity = just_index_capacity(pjtree->length)))
+        return just_index_find(pstore, pstore->index + pstore->indexTables[just_ipt_index(tree)], capacity, hash, ipt);
+
+    pnode = pstore->nodes + pjtree->offset;
+    for (pend = pnode + pjtree->length; pnode < pend; ++pnode)
+        if (pnode->name == ipt)
+            return pnode;
+    return nullptr;
+}
+
+// Get elements of the array in vault (typed span), nullptr: tree is not array of type.
+// Elements of an array are allocated in a row (see. just_avail), array of one type is a row in the vault:
+// first and last elements of type and distance of the indexes is length.
+method const void* just_storage_get_span(const just_storage* pstore, int tree, JustType type, jnumber* length)
+{
+    const jtree_t* pjtree;
+    const jnode_t* first;
+    const jnode_t* last;
+
+    if (just_ipt_type(tree) != JustType::JustTree)
+        return nullptr;
+    pjtree = static_cast<const jtree_t*>(just_storage_get_pointer(pstore, tree));
+    *length = pjtree->length;
+    if (!pjtree->length)
+        return pstore->vault[static_cast<int>(type) - 1];
+
+    first = pstore->nodes + pjtree->offset;
+    last = first + pjtree->length - 1;
+    if (first->name != Invalid_IPT || just_ipt_type(first->value) != type || just_ipt_type(last->value) != type || just_ipt_index(last->value) - just_ipt_index(first->value) != last - first)
+        return nullptr;
+    return just_storage_get_pointer(pstore, first->value);
+}
+
+// Optimize storage (ordering and compress)
+// Regions are moved to one block in vault order: bools, numbers, reals, strings, trees, nodes, pool.
+// After it the storage is frozen (read only).
+method bool just_storage_optimize(just_storage** pstore)
+{
+    just_storage* pstorage = *pstore;
+
+    if (pstorage->optimized)
+        return true;
+
+    // fixed arena is reserved from statistics, interned strings leave it with unused tail (compact it)
+    if (!pstorage->arena || pstorage->reserved[3] != pstorage->numStrings || (just_storage_in_arena(pstorage, pstorage->pool) && pstorage->poolReserved != pstorage->poolSize))
+        just_storage_arena(pstorage, &pstorage->numBools, pstorage->numNodes, pstorage->poolSize, true);
+
+    pstorage->optimized = true;
+    return true;
+}
+
+// Merge storages of the top-level blocks (shards, see. just_split_blocks) in document order, IPT and offsets is rebased.
+// Root nodes of the shards are nodes of the root tree. Root tree of a shard is committed last (nodes in tail).
+// Strings are interned again (equal strings of the shards is stored once).
+method void just_storage_merge(just_storage* pstore, just_storage* const* shards, std::size_t count)
+{
+    int x;
+    std::size_t k;
+    jtree_t* trees;
+    just_string_t* strings;
+    std::vector<int> interned;
+    jnumber counts[5] = { 0, 0, 0, 0, 1 };
+    jnumber bases[5] = { 0, 0, 0, 0, 1 };
+    jnumber numNodes = 0, numRoot = 0, poolSize = 0;
+    jnumber nodeBase, rootBase = 0;
+
+    for (k = 0; k < count; ++k) {
+        for (x = 0; x < 5; ++x)
+            counts[x] += (&shards[k]->numBools)[x];
+        // root tree of the shard is not copied
+        --counts[4];
+        numNodes += shards[k]->numNodes;
+        numRoot += static_cast<const jtree_t*>(shards[k]->vault[static_cast<int>(JustType::JustTree) - 1])->length;
+        poolSize += shards[k]->poolSize;
+        pstore->internHits += shards[k]->internHits;
+    }
+
+    just_storage_arena(pstore, counts, numNodes, poolSize, true);
+    trees = static_cast<jtree_t*>(pstore->vault[static_cast<int>(JustType::JustTree) - 1]);
+    strings = static_cast<just_string_t*>(pstore->vault[static_cast<int>(JustType::JustString) - 1]);
+    trees->offset = 0;
+    trees->length = static_cast<std::uint32_t>(numRoot);
+    nodeBase = numRoot;
+
+    for (k = 0; k < count; ++k) {
+        const just_storage* shard = shards[k];
+        const jtree_t* shardTrees = static_cast<const jtree_t*>(shard->vault[static_cast<int>(JustType::JustTree) - 1]);
+        const just_string_t* shardStrings = static_cast<const just_string_t*>(shard->vault[static_cast<int>(JustType::JustString) - 1]);
+        auto rebase = [&bases, &interned](int ipt) {
+            if (ipt < 0)
+                return ipt;
+            JustType type = just_ipt_type(ipt);
+            if (type == JustType::JustString)
+                return interned[just_ipt_index(ipt)];
+            // tree 0 of the shard is root (is not copied)
+            return just_ipt_make(type, just_ipt_index(ipt) + bases[static_cast<int>(type) - 1] - (type == JustType::JustTree));
+        };
+
+        // values
+        for (x = 0; x < 3; ++x)
+            if ((&shard->numBools)[x])
+                std::memcpy(static_cast<char*>(pstore->vault[x]) + bases[x] * just_type_size(static_cast<JustType>(x + 1)), shard->vault[x], (&shard->numBools)[x] * just_type_size(static_cast<JustType>(x + 1)));
+        interned.resize(shard->numStrings);
+        for (jnumber y = 0; y < shard->numStrings; ++y) {
+            just_string_t* str = strings + pstore->numStrings++;
+            *str = shardStrings[y];
+            if (!(str->flags & String_BorrowedFlag)) {
+                std::memcpy(pstore->pool + pstore->poolSize, shard->pool + str->offset, str->length + 1);
+                str->offset = pstore->poolSize;
+                pstore->poolSize += str->length + 1;
             }
+            interned[y] = just_storage_intern(pstore, shard->hashes[y]);
+        }
+
+        // trees and nodes
+        for (jnumber y = 1; y < shard->numTrees; ++y) {
+            jtree_t* pjtree = trees + bases[4] + y - 1;
+            pjtree->offset = static_cast<std::uint32_t>(nodeBase + shardTrees[y].offset);
+            pjtree->length = shardTrees[y].length;
+        }
+        for (jnumber y = 0; y < shard->numNodes; ++y) {
+            jnode_t* pnode = pstore->nodes + (y < shardTrees->offset ? nodeBase + y : rootBase + y - shardTrees->offset);
+            pnode->name = rebase(shard->nodes[y].name);
+            pnode->value = rebase(shard->nodes[y].value);
         }
+
+        for (x = 0; x < 5; ++x)
+            bases[x] += (&shard->numBools)[x];
+        --bases[4];
+        nodeBase += shard->numNodes - shardTrees->length;
+        rootBase += shardTrees->length;
     }
-    return result;
+
+    for (x = 0; x < 5; ++x)
+        if (x != static_cast<int>(JustType::JustString) - 1)
+            (&pstore->numBools)[x] = counts[x];
+    pstore->numNodes = numNodes;
 }
 
-// Just Object Node
+// Memory of the region: live bytes and reserved (region in arena or image is aligned, other is own block)
+method void just_storage_region_usage(const just_storage* pstore, const void* block, jnumber live, jnumber reserved, just_memory_bytes* usage)
+{
+    bool inside = pstore->external ? block >= pstore->source && block <= pstore->source + pstore->sourceLength : just_storage_in_arena(pstore, block);
+    usage->live += live;
+    usage->reserved += inside ? just_storage_align(reserved) : system_block_size(block, reserved);
+}
 
-just_object_node::just_object_node(just_object_parser* owner, void* handle)
+// Memory of the storage by types (node objects is not included)
+method void just_storage_usage(const just_storage* pstore, just_memory_usage* usage)
 {
-    this->_jowner = owner;
-    this->_jhead = handle;
+    int x;
+    jnumber size;
+    just_memory_bytes* types[] = { &usage->bools, &usage->numbers, &usage->reals, &usage->strings, &usage->trees };
+
+    for (x = 0; x < 5; ++x) {
+        size = just_type_size(static_cast<JustType>(x + 1));
+        just_storage_region_usage(pstore, pstore->vault[x], (&pstore->numBools)[x] * size, pstore->reserved[x] * size, types[x]);
+    }
+    // characters of the copied strings (borrowed is in the source)
+    just_storage_region_usage(pstore, pstore->pool, pstore->poolSize, pstore->poolReserved, &usage->strings);
+    just_storage_region_usage(pstore, pstore->nodes, pstore->numNodes * sizeof(jnode_t), pstore->nodesReserved * sizeof(jnode_t), &usage->trees);
+    just_storage_region_usage(pstore, pstore->lazy, pstore->lazy ? pstore->numTrees * sizeof(just_lazy_block) : 0, pstore->lazyReserved * sizeof(just_lazy_block), &usage->trees);
+    just_storage_region_usage(pstore, pstore->rows, pstore->rows ? pstore->numTrees * sizeof(just_row) : 0, pstore->rowsReserved * sizeof(just_row), &usage->trees);
+
+    // indexes
+    size = pstore->indexTables ? pstore->numTrees * sizeof(jnumber) : 0;
+    just_storage_region_usage(pstore, pstore->indexTables, size, size, &usage->index);
+    size = pstore->indexSize * sizeof(just_index_slot);
+    just_storage_region_usage(pstore, pstore->index, size, size, &usage->index);
+    size = pstore->searchCapacity * sizeof(just_index_slot);
+    just_storage_region_usage(pstore, pstore->searchIndex, size, size, &usage->index);
+    just_storage_region_usage(pstore, pstore->intern, pstore->numStrings * sizeof(just_index_slot), pstore->internCapacity * sizeof(just_index_slot), &usage->index);
+    just_storage_region_usage(pstore, pstore->hashes, pstore->hashes ? pstore->numStrings * sizeof(std::uint64_t) : 0, pstore->hashesReserved * sizeof(std::uint64_t), &usage->index);
+
+    for (just_memory_bytes* type : { &usage->bools, &usage->numbers, &usage->reals, &usage->strings, &usage->trees, &usage->index }) {
+        usage->total.live += type->live;
+        usage->total.reserved += type->reserved;
+    }
+    // storage header and slack of the arena block
+    usage->total.live += sizeof(just_storage);
+    usage->total.reserved += system_block_size(pstore, sizeof(just_storage));
+    if (pstore->arena)
+        usage->total.reserved += system_block_size(pstore->arena, pstore->arenaSize) - pstore->arenaSize;
+
+    usage->storedStrings = pstore->numStrings;
+    usage->stringReferences = pstore->numStrings + pstore->internHits;
+    usage->dedupRatio = usage->storedStrings ? static_cast<jreal>(usage->stringReferences) / usage->storedStrings : 1.0;
 }
 
-method JustType just_object_node::type() const { just_storage_get_type(static_cast<just_storage*>(this->_jowner->_storage), _jhead); }
+// method for make Internal Pointer (IPT) from type and index
+method inline int just_ipt_make(const JustType type, jnumber index)
+{
+    if (index > IPT_IndexMask)
+        throw std::length_error("storage is full");
+    return (static_cast<int>(type) << IPT_TypeShift) | static_cast<int>(index);
+}
 
-method just_object_node* just_object_node::tree(const jstring& child) { return nullptr; }
+// method for get type from Internal Pointer (IPT)
+method inline JustType just_ipt_type(const int ipt) { return ipt < 0 ? JustType::Null : static_cast<JustType>(ipt >> IPT_TypeShift); }
 
-method jbool just_object_node::has_tree() const { throw std::runtime_error("This is method not implemented"); }
+// method for get index in typed region from Internal Pointer (IPT)
+method inline int just_ipt_index(const int ipt) { return ipt & IPT_IndexMask; }
 
-jstring just_object_node::to_string() const
+// method for get 64-bit hash from string (by words, the last word is mixed)
+method inline std::uint64_t just_string_hash(const char* char_side, int contentLength)
 {
-    switch (type()) {
-    case JustType::JustString:
-        return get_str();
-    case JustType::JustNumber:
-        return std::to_string(get_int());
-    case JustType::JustBoolean:
-        return std::to_string(get_bool());
-    case JustType::JustReal:
-        return std::to_string(get_real());
-    case JustType::Unknown:
-        return jstring(just_syntax.just_unknown_string);
-    case JustType::Null:
-        return jstring(just_syntax.just_null_string);
+    std::uint64_t word;
+    std::uint64_t hash = 14695981039346656037ULL ^ static_cast<std::uint64_t>(contentLength);
+    for (; contentLength >= static_cast<int>(sizeof(word)); contentLength -= sizeof(word), char_side += sizeof(word)) {
+        std::memcpy(&word, char_side, sizeof(word));
+        hash = (hash ^ word) * 0x9E3779B97F4A7C15ULL;
+        hash ^= hash >> 32;
     }
-    return {};
+    if (contentLength > 0) {
+        word = 0;
+        std::memcpy(&word, char_side, contentLength);
+        hash = (hash ^ word) * 0x9E3779B97F4A7C15ULL;
+    }
+    // low bits depend on all characters (see. just_index_find)
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    return hash;
 }
 
-just_object_node::operator jnumber() const { return get_int(); }
+// method for scan string in quotes, return offset of the closing quote or 0 (is not closed)
+method int just_scan_string(const char* char_side, int contentLength, jbool* escaped)
+{
+    int offset = 1;
+    *escaped = false;
+    for (; offset < contentLength && char_side[offset] != just_syntax.just_format_string; ++offset)
+        if (char_side[offset] == just_syntax.just_left_seperator) {
+            *escaped = true;
+            // next character is escaped (quote or separator also), see. just_unescape
+            ++offset;
+        }
+    return offset < contentLength ? offset : 0;
+}
 
-just_object_node::operator jbool() const { return get_bool(); }
+// method for copy characters of the string without escape (\n, \r, \t is control characters, another is self), out is null: only length
+method int just_unescape(const char* char_side, int length, char* out)
+{
+    int x, y;
+    char c;
+    const char* escape;
+    for (x = 0, y = 0; x < length; ++x, ++y) {
+        c = char_side[x];
+        if (c == just_syntax.just_left_seperator) {
+            c = char_side[++x];
+            if ((escape = static_cast<const char*>(std::memchr(just_syntax.just_escape_segments[0], c, sizeof(just_syntax.just_escape_segments[0])))))
+                c = just_syntax.just_escape_segments[1][escape - just_syntax.just_escape_segments[0]];
+        }
+        if (out)
+            out[y] = c;
+    }
+    return y;
+}
 
-just_object_node::operator jreal() const { return get_real(); }
+// method for check valid a unsigned number
+method inline bool just_is_unsigned_jnumber(const char char_side) { return static_cast<unsigned>(char_side - '0') < 10; }
 
-just_object_node::operator jstring() const { return get_str(); }
+// method for convert real without locale (slow path, see. just_scan_number)
+method jreal just_strtod_c(const char* char_side, int length)
+{
+    jreal conv;
+    char local[64];
+    jstring buffer;
+    const char* chars;
+    // short number on stack (without allocation)
+    if (length < static_cast<int>(sizeof(local))) {
+        std::memcpy(local, char_side, length);
+        local[length] = '\0';
+        chars = local;
+    } else {
+        buffer.assign(char_side, length);
+        chars = buffer.c_str();
+    }
+#if defined(__GLIBC__)
+    static locale_t c_locale = newlocale(LC_ALL_MASK, "C", nullptr);
+    conv = strtod_l(chars, nullptr, c_locale);
+#elif defined(_WIN32)
+    static _locale_t c_locale = _create_locale(LC_NUMERIC, "C");
+    conv = _strtod_l(chars, nullptr, c_locale);
+#else
+    std::istringstream stream(chars);
+    stream.imbue(std::locale::classic());
+    stream >> conv;
+#endif
+    return conv;
+}
 
-method const jstring just_object_node::name() const { return jstring(static_cast<char*>(_jhead)); }
+// exactly powers of ten for double
+static const jreal just_powers10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+// "C" locale of the thread while the scope is alive (see. just_dtoa_c), nested scope is not switch locale again
+// serialization opens one scope for all reals of the document
+struct just_locale_scope {
+#if defined(__GLIBC__)
+    locale_t last;
+    just_locale_scope() : last(depth()++ ? nullptr : uselocale(c_locale())) { }
+    ~just_locale_scope()
+    {
+        if (!--depth())
+            uselocale(last);
+    }
+    static int& depth()
+    {
+        static thread_local int value = 0;
+        return value;
+    }
+    static locale_t c_locale()
+    {
+        static locale_t value = newlocale(LC_ALL_MASK, "C", nullptr);
+        return value;
+    }
+#else
+    just_locale_scope() { }
+#endif
+};
 
-method void just_avail_only(just_stats& jstat, const char* source, int length)
+// method for format real without locale, return length
+method int just_dtoa_c(jreal value, int precision, char* out, int size)
 {
-    int x, z;
-    int depth; // depths
-    JustType valueType;
-    JustType current_block_type;
-    just_storage* pstorage;
-    std::vector<jtree_t*> tree;
-    const char* pointer = source;
-    const char* epointer = source + length;
+    int length;
+#if defined(__GLIBC__)
+    just_locale_scope scope;
+    length = std::snprintf(out, size, "%.*g", precision, value);
+#elif defined(_WIN32)
+    static _locale_t c_locale = _create_locale(LC_NUMERIC, "C");
+    length = _snprintf_l(out, size, "%.*g", c_locale, precision, value);
+#else
+    std::ostringstream stream;
+    stream.imbue(std::locale::classic());
+    stream << std::setprecision(precision) << value;
+    length = static_cast<int>(stream.str().copy(out, size - 1));
+    out[length] = '\0';
+#endif
+    return length;
+}
 
-    // TODO: Linear load
+// method for scan and convert number in one pass (locale-free), return length or 0 (is not a number)
+// syntax: [-+]digits[.digits][(e|E)[-+]digits], the real has a dot or exponent
+method int just_scan_number(const char* char_side, int contentLength, JustType* containType, jnumber* number, jreal* real)
+{
+    // digits of the mantissa is not overflow
+    const int maxDigits = 19;
+
+    int x = 0, digits = 0, significant = 0, exp10 = 0;
+    jbool negative = false, dot = false, exponent = false, truncated = false;
+    std::uint64_t mantissa = 0;
+
+    if (x < contentLength && (char_side[x] == just_syntax.just_negative_sym || char_side[x] == just_syntax.just_positive_sym))
+        negative = char_side[x++] == just_syntax.just_negative_sym;
+
+    for (; x < contentLength; ++x) {
+        unsigned digit = static_cast<unsigned>(char_side[x] - '0');
+        if (digit < 10) {
+            ++digits;
+            if (significant < maxDigits) {
+                mantissa = mantissa * 10 + digit;
+                // leading zeros is not significant
+                significant += mantissa != 0;
+                exp10 -= dot;
+            } else {
+                truncated |= digit != 0;
+                exp10 += !dot;
+            }
+        } else if (char_side[x] == just_syntax.just_dot && !dot)
+            dot = true;
+        else
+            break;
+    }
 
-    pstorage = just_storage_new_init();
+    if (!digits)
+        return 0;
+
+    // exponent
+    if (x + 1 < contentLength && (char_side[x] == 'e' || char_side[x] == 'E')) {
+        int y = x + 1, value = 0;
+        jbool negativeExp = false;
+        if (char_side[y] == just_syntax.just_negative_sym || char_side[y] == just_syntax.just_positive_sym)
+            negativeExp = char_side[y++] == just_syntax.just_negative_sym;
+        if (y < contentLength && just_is_unsigned_jnumber(char_side[y])) {
+            for (; y < contentLength && just_is_unsigned_jnumber(char_side[y]); ++y)
+                if (value < 100000)
+                    value = value * 10 + (char_side[y] - '0');
+            exp10 += negativeExp ? -value : value;
+            exponent = true;
+            x = y;
+        }
+    }
 
-    tree.emplace_back(just_storage_alloc_tree(&pstorage));
+    if (!dot && !exponent && !truncated && exp10 == 0 && mantissa <= static_cast<std::uint64_t>(INT64_MAX) + negative) {
+        // Number type
+        *containType = JustType::JustNumber;
+        *number = negative ? static_cast<jnumber>(0 - mantissa) : static_cast<jnumber>(mantissa);
+        return x;
+    }
 
-    for (depth = x = 0; pointer + x < epointer;) {
-        // has comment line
-        int y = x += just_autoskip_comment(pointer + x, length - x);
-        if (depth > 0 && pointer[x] == just_syntax.just_block_segments[1])
-            // TODO: Next Depth (Up)
-            break;
-        x += just_skip(pointer + x, length - x);
+    // Real type (also is a big number)
+    *containType = JustType::JustReal;
+    if (!truncated && mantissa <= (std::uint64_t(1) << 53) && exp10 >= -22 && exp10 <= 22) {
+        // fast path: mantissa and power is exactly, one rounding
+        *real = static_cast<jreal>(mantissa);
+        *real = exp10 < 0 ? *real / just_powers10[-exp10] : *real * just_powers10[exp10];
+    } else if (mantissa == 0 && !truncated)
+        *real = 0;
+    else
+        *real = just_strtod_c(char_side + negative, x - negative);
+    if (negative)
+        *real = -*real;
+    return x;
+}
 
-        // check property name
-        if (!just_valid_property_name(pointer + y, x - y))
-            throw std::bad_exception();
+// method for check valid a signed number
+method inline bool just_is_jnumber(const char* char_side, int contentLength, int* getLength)
+{
+    JustType type;
+    jnumber number;
+    jreal real;
+    int x = just_scan_number(char_side, contentLength, &type, &number, &real);
+    if (getLength)
+        *getLength = x;
+    return x && type == JustType::JustNumber;
+}
 
-        // property name
-        // prototype_node.propertyName.append(just_source + y, static_cast<size_t>(x - y));
+// method for check is real ?
+method jbool just_is_jreal(const char* char_side, int contentLength, int* getLength)
+{
+    JustType type;
+    jnumber number;
+    jreal real;
+    int x = just_scan_number(char_side, contentLength, &type, &number, &real);
+    if (getLength)
+        *getLength = x;
+    return x && type == JustType::JustReal;
+}
 
-        std::cout << jstring(pointer + y, static_cast<size_t>(x - y)) << std::endl;
+// method for check is bool ?
+method inline jbool just_is_jbool(const char* char_side, int contentLength, int* getLength)
+{
+    if (contentLength >= static_cast<int>(sizeof(just_syntax.just_true_string) - 1) && !std::memcmp(char_side, just_syntax.just_true_string, *getLength = sizeof(just_syntax.just_true_string) - 1))
+        return true;
+    if (contentLength >= static_cast<int>(sizeof(just_syntax.just_false_string) - 1) && !std::memcmp(char_side, just_syntax.just_false_string, *getLength = sizeof(just_syntax.just_false_string) - 1))
+        return true;
+    *getLength = 0;
+    return false;
+}
 
-        // has comment line
-        x += just_autoskip_comment(pointer + x, length - x);
-        // x += just_trim(pointer + x, length - x); // trim string
-        // is block or array
-        if (pointer[x] == *just_syntax.just_block_segments) {
-            if (just_is_array(pointer + x, y, length - x)) {
-                y += x++;
-                current_block_type = JustType::Unknown;
-                // prototype_node.flags = Node_ArrayFlag;
-                for (; x < y;) {
-                    x += just_autoskip_comment(pointer + x, y - x);
-                    // next index
-                    if (pointer[x] == just_syntax.just_obstacle)
-                        ++x;
-                    else {
-                        x += z = just_get_format(pointer + x, nullptr, valueType);
-
-                        // Just Node Object current value Type
-
-                        if (valueType != JustType::Unknown) {
-                            if (current_block_type == JustType::Unknown) {
-                                current_block_type = valueType;
-                                switch (current_block_type) {
-                                case JustType::JustString:
-                                    ++jstat.jarrstrings;
-                                    break;
-                                case JustType::JustBoolean:
-                                    ++jstat.jarrbools;
-                                    break;
-                                case JustType::JustReal:
-                                    ++jstat.jarrreals;
-                                    break;
-                                case JustType::JustNumber:
-                                    ++jstat.jarrnumbers;
-                                    break;
-                                }
-                            }
-                            // can't convert just numbers as JustReal
-                            else if (false && current_block_type != valueType)
-                                throw std::runtime_error("Multi type is found.");
-
-                            switch (current_block_type) {
-                            case JustType::JustString:
-                                jstat.jarrstrings_total_bytes += z - 1;
-                                // prototype_node.set_native_memory((void*)jalloc<std::vector<jstring>>());
-                                break;
-                            case JustType::JustBoolean:
-                                jstat.jarrbools_total_bytes += z;
-                                // prototype_node.set_native_memory((void*)jalloc<std::vector<jbool>>());
-                                break;
-                            case JustType::JustReal:
-                                jstat.jarrreals_total_bytes += z;
-                                // prototype_node.set_native_memory((void*)jalloc<std::vector<jreal>>());
-                                break;
-                            case JustType::JustNumber:
-                                jstat.jarrnumbers_total_bytes += z;
-                                // prototype_node.set_native_memory((void*)jalloc<std::vector<jnumber>>());
-                                break;
-                            }
-                        }
-                    }
-                    x += just_autoskip_comment(pointer + x, y - x);
-                }
+// method for get format from raw content, also to write in storage pointer
+method int just_get_format(const char* char_side, int contentLength, just_storage** storage, JustType& containType, int* outValue = nullptr)
+{
+    /*
+         * Priority:
+         *  - JReal
+         *  - JNumber
+         *  - JBool
+         *  - JString
+         */
 
-            } else { // enter the next node
-                // up next node
-                // x += just_avail_only(jstat, pointer + x, length - x);
-                tree.emplace_back(just_storage_alloc_tree(&pstorage, tree.back())); // alloc tree on owner
+    int offset = 0;
+    int value = Invalid_IPT;
+    jnumber number;
+    jreal real;
 
-                ++x;
-                ++depth;
-                // x += just_autoskip_comment(pointer + x, length - x);
+    // Null type
+    if (char_side == nullptr || contentLength <= 0 || *char_side == '\0') {
+        containType = JustType::Null;
+    } else if ((offset = just_scan_number(char_side, contentLength, &containType, &number, &real))) { // Real or Number type ---------------------
+        if (storage) {
+            // Copy to
+            if (containType == JustType::JustReal)
+                std::memcpy(just_storage_alloc_field(storage, containType), &real, just_type_size(containType));
+            else
+                std::memcpy(just_storage_alloc_field(storage, containType), &number, just_type_size(containType));
+        }
+    } else if (just_is_jbool(char_side, contentLength, &offset)) { // Bool type -----------------------------------------------------------------------------
+        containType = JustType::JustBoolean;
+        if (storage) {
+            jbool conv = (offset == sizeof(just_syntax.just_true_string) - 1);
+            // Copy to
+            std::memcpy(just_storage_alloc_field(storage, containType), &conv, just_type_size(containType));
+        }
+    } else if (*char_side == just_syntax.just_format_string) { // String type ----------------------------------------------------------------
+        jbool escaped;
+        if (!(offset = just_scan_string(char_side, contentLength, &escaped))) {
+            // Error: string is not closed
+            containType = JustType::Unknown;
+            return 0;
+        }
+        containType = JustType::JustString;
+        --offset;
+        if (storage) {
+            if (!escaped && (*storage)->source && char_side >= (*storage)->source && char_side + offset < (*storage)->source + (*storage)->sourceLength) {
+                // refer to borrowed source (zero-copy)
+                just_storage_alloc_string_ref(storage, char_side + 1, offset);
+            } else {
+                // Copy to
+                just_unescape(char_side + 1, offset, static_cast<char*>(just_storage_alloc_field(storage, containType, just_unescape(char_side + 1, offset, nullptr))));
             }
+            value = just_storage_intern(*storage);
+        }
+        offset += 2;
+    } else // another type
+        containType = JustType::Unknown;
 
-            if (false && pointer[x] != just_syntax.just_block_segments[1]) {
-                // Error: Line in require end depth
-                throw std::bad_exception();
-            }
-        } else { // get also value
-            x += z = just_get_format(pointer + x, nullptr, valueType);
+    if (storage && outValue && value == Invalid_IPT)
+        value = containType > JustType::Null ? just_ipt_make(containType, (&(*storage)->numBools)[static_cast<int>(containType) - 1] - 1) : Invalid_IPT;
+    if (outValue)
+        *outValue = value;
 
-            switch (valueType) {
-            case JustType::JustString:
-                ++jstat.jstrings;
-                jstat.jarrnumbers_total_bytes += z - 1;
-                break;
-            case JustType::JustBoolean:
-                ++jstat.jbools;
-                jstat.jarrbools_total_bytes += z;
-                break;
-            case JustType::JustReal:
-                ++jstat.jreals;
-                jstat.jarrreals_total_bytes += z;
-                break;
-            case JustType::JustNumber:
-                ++jstat.jnumbers;
-                jstat.jarrnumbers_total_bytes += z;
-                break;
-            }
+    return offset;
+}
+
+// method for check. has type in value
+method inline jbool just_has_datatype(const char* char_side, int contentLength)
+{
+    JustType type;
+    just_get_format(char_side, contentLength, nullptr, type);
+    return type > JustType::Null;
+}
+
+// character classes for the scalar classify
+enum {
+    Class_Space = 1,
+    Class_Open = 2,
+    Class_Close = 4,
+    Class_Obstacle = 8,
+    Class_Quote = 16,
+    Class_Slash = 32,
+    Class_Eol = 64
+};
+
+static const struct just_class_table_t {
+    std::uint8_t classes[256];
+
+    just_class_table_t()
+        : classes()
+    {
+        for (char c : just_syntax.just_trim_segments)
+            classes[static_cast<std::uint8_t>(c)] |= Class_Space;
+        classes[static_cast<std::uint8_t>(just_syntax.just_block_segments[0])] |= Class_Open;
+        classes[static_cast<std::uint8_t>(just_syntax.just_block_segments[1])] |= Class_Close;
+        classes[static_cast<std::uint8_t>(just_syntax.just_obstacle)] |= Class_Obstacle;
+        classes[static_cast<std::uint8_t>(just_syntax.just_format_string)] |= Class_Quote;
+        classes[static_cast<std::uint8_t>(just_syntax.just_commentLine[0])] |= Class_Slash;
+        classes[static_cast<std::uint8_t>(just_syntax.just_eol_segment)] |= Class_Eol;
+        classes[0] |= Class_Eol;
+    }
+} just_class_table;
+
+// classify block (Block_Size) without vector instructions
+method void just_classify_scalar(const char* block, just_block_masks* masks)
+{
+    std::uint64_t slash = 0;
+    std::memset(masks, 0, sizeof(just_block_masks));
+    for (int x = 0; x < Block_Size; ++x) {
+        std::uint64_t bit = std::uint64_t(1) << x;
+        std::uint8_t c = just_class_table.classes[static_cast<std::uint8_t>(block[x])];
+        if (c) {
+            masks->space |= (c & Class_Space) ? bit : 0;
+            masks->open |= (c & Class_Open) ? bit : 0;
+            masks->close |= (c & Class_Close) ? bit : 0;
+            masks->obstacle |= (c & Class_Obstacle) ? bit : 0;
+            masks->quote |= (c & Class_Quote) ? bit : 0;
+            masks->eol |= (c & Class_Eol) ? bit : 0;
+            slash |= (c & Class_Slash) ? bit : 0;
+        }
+    }
+    masks->comment = slash & ((slash >> 1) | (std::uint64_t(1) << (Block_Size - 1)));
+}
+
+#if JUST_SCAN_SSE2
+// classify block (Block_Size) by SSE2, 16 bytes per step
+method void just_classify_sse2(const char* block, just_block_masks* masks)
+{
+    std::uint64_t slash = 0;
+    std::memset(masks, 0, sizeof(just_block_masks));
+    for (int x = 0; x < Block_Size; x += 16) {
+        __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + x));
+#define classify(ch) (static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, _mm_set1_epi8(ch))))) << x)
+        for (char c : just_syntax.just_trim_segments)
+            masks->space |= classify(c);
+        masks->open |= classify(just_syntax.just_block_segments[0]);
+        masks->close |= classify(just_syntax.just_block_segments[1]);
+        masks->obstacle |= classify(just_syntax.just_obstacle);
+        masks->quote |= classify(just_syntax.just_format_string);
+        masks->eol |= classify(just_syntax.just_eol_segment) | classify('\0');
+        slash |= classify(just_syntax.just_commentLine[0]);
+#undef classify
+    }
+    masks->comment = slash & ((slash >> 1) | (std::uint64_t(1) << (Block_Size - 1)));
+}
+#endif
+
+#if JUST_SCAN_AVX2
+// classify block (Block_Size) by AVX2, 32 bytes per step
+__attribute__((target("avx2"))) method void just_classify_avx2(const char* block, just_block_masks* masks)
+{
+    std::uint64_t slash = 0;
+    std::memset(masks, 0, sizeof(just_block_masks));
+    for (int x = 0; x < Block_Size; x += 32) {
+        __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + x));
+#define classify(ch) (static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8(ch))))) << x)
+        for (char c : just_syntax.just_trim_segments)
+            masks->space |= classify(c);
+        masks->open |= classify(just_syntax.just_block_segments[0]);
+        masks->close |= classify(just_syntax.just_block_segments[1]);
+        masks->obstacle |= classify(just_syntax.just_obstacle);
+        masks->quote |= classify(just_syntax.just_format_string);
+        masks->eol |= classify(just_syntax.just_eol_segment) | classify('\0');
+        slash |= classify(just_syntax.just_commentLine[0]);
+#undef classify
+    }
+    masks->comment = slash & ((slash >> 1) | (std::uint64_t(1) << (Block_Size - 1)));
+}
+#endif
+
+typedef void (*just_classify_method)(const char* block, just_block_masks* masks);
+
+// select classify method by CPU
+method just_classify_method just_classify_select()
+{
+#if JUST_SCAN_AVX2
+    if (__builtin_cpu_supports("avx2"))
+        return just_classify_avx2;
+#endif
+#if JUST_SCAN_SSE2
+    return just_classify_sse2;
+#else
+    return just_classify_scalar;
+#endif
+}
+
+// classify block (Block_Size), the method is selected once on first call (static initialization is thread-safe)
+method inline void just_classify(const char* block, just_block_masks* masks)
+{
+    static const just_classify_method classify = just_classify_select();
+    classify(block, masks);
+}
+
+// method for get index of the first bit
+method inline int just_first_bit(std::uint64_t bits)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(bits);
+#else
+    int x = 0;
+    for (; !(bits & 1); bits >>= 1)
+        ++x;
+    return x;
+#endif
+}
+
+// Scan index of the content, blocks is classified on query (see. just_scan_masks)
+method inline just_scan_index just_scan_content(const char* begin, jnumber length)
+{
+    just_scan_index scan;
+    scan.begin = begin;
+    scan.length = length;
+    scan.first = 0;
+    return scan;
+}
+
+// Masks of the block (number of the block from begin of the content).
+// NOTE: Only content is read, the tail of the last block is classified from zero-padded copy
+method inline const just_block_masks* just_scan_masks(just_scan_index* scan, jnumber block)
+{
+    jnumber filled = static_cast<jnumber>(scan->blocks.size());
+    jnumber offset;
+
+    if (!filled || block < scan->first || block >= scan->first + Scan_Window) {
+        scan->blocks.clear();
+        scan->first = block;
+        filled = 0;
+    }
+    // blocks before the queried is classified also (the window is continuous)
+    for (; scan->first + filled <= block; ++filled) {
+        scan->blocks.resize(filled + 1);
+        offset = (scan->first + filled) * Block_Size;
+        if (offset + Block_Size <= scan->length)
+            just_classify(scan->begin + offset, &scan->blocks.back());
+        else {
+            alignas(Block_Size) char tail[Block_Size] = {};
+            std::memcpy(tail, scan->begin + offset, scan->length - offset);
+            just_classify(tail, &scan->blocks.back());
+        }
+    }
+    return &scan->blocks[block - scan->first];
+}
+
+// method for get first structural position from masks selector, or length. char_side is in content of the scan
+template <typename Selector>
+method inline int just_scan_first(just_scan_index* scan, const char* char_side, int length, Selector selector)
+{
+    int x = 0;
+    std::uint64_t bits;
+    jnumber offset = char_side - scan->begin;
+    jnumber block = offset / Block_Size;
+    int shift = static_cast<int>(offset % Block_Size);
+
+    for (; x < length; ++block) {
+        if ((bits = selector(just_scan_masks(scan, block)) >> shift)) {
+            x += just_first_bit(bits);
+            return x < length ? x : length;
+        }
+        x += Block_Size - shift;
+        shift = 0;
+    }
+    return length > 0 ? length : 0;
+}
+
+// method for trim tabs, space, EOL (etc) to skip.
+method int just_trim(just_scan_index* scan, const char* char_side, int contentLength)
+{
+    // fast path: nothing to trim
+    if (char_side == nullptr || contentLength <= 0 || !just_is_space(*char_side))
+        return 0;
+
+    // first is not a space (null-terminator also)
+    return just_scan_first(scan, char_side, contentLength, [](const just_block_masks* masks) { return ~masks->space; });
+}
+
+method int just_skip(just_scan_index* scan, const char* char_side, int length)
+{
+    // first is a space or block segment
+    return just_scan_first(scan, char_side, length, [](const just_block_masks* masks) { return masks->space | masks->open | masks->close; });
+}
+
+method inline jbool just_valid_property_name(const char* char_side, int len)
+{
+    int x;
+    for (x = 0; x < len; ++x, ++char_side)
+        if (!((*char_side >= *just_syntax.just_valid_property_name && *char_side <= just_syntax.just_valid_property_name[1]) || (x && just_is_unsigned_jnumber(*char_side)) || *char_side == just_syntax.just_valid_property_name[2]))
+            return false;
+    return len != 0;
+}
+
+method inline jbool just_is_comment_line(const char* char_side, int len) { return len > 0 && !std::strncmp(char_side, just_syntax.just_commentLine, std::min(2, len)); }
+
+method inline int just_has_eol(just_scan_index* scan, const char* pointer, int len)
+{
+    // first is EOL (null-terminator also)
+    return just_scan_first(scan, pointer, len, [](const just_block_masks* masks) { return masks->eol; });
+}
+
+// method for skip comment's
+method int just_autoskip_comment(just_scan_index* scan, const char* char_side, int len)
+{
+    int offset;
+    const char* pointer = char_side;
+    pointer += offset = just_trim(scan, pointer, len);
+    while (just_is_comment_line(pointer, len - offset)) {
+        // skip to EOL
+        int skipped;
+        pointer += skipped = just_has_eol(scan, pointer, len - offset);
+        offset += skipped;
+        // trimming
+        pointer += skipped = just_trim(scan, pointer, len - offset);
+        offset += skipped;
+    }
+    return offset;
+}
+
+method inline jbool just_is_space(const char char_side) { return just_class_table.classes[static_cast<std::uint8_t>(char_side)] & Class_Space; }
+
+// Block is array when first token is a value or block is empty (see. just_reader).
+// endpoint - closing brace of the array, opening brace of a nested block (is not valid element) or unclosed string,
+// -1: array is not closed.
+// Strings and comments is skipped (see. just_block_end)
+method jbool just_is_array(just_scan_index* scan, const char* char_side, int& endpoint, int contentLength)
+{
+    int x = 1, y;
+    jbool escaped;
+
+    if (*char_side != *just_syntax.just_block_segments)
+        return false;
+
+    x += just_autoskip_comment(scan, char_side + x, contentLength - x);
+    if (!just_has_datatype(char_side + x, contentLength - x) && !(x < contentLength && char_side[x] == just_syntax.just_block_segments[1]))
+        return false;
+
+    endpoint = -1;
+    while (x < contentLength) {
+        x += y = just_scan_first(scan, char_side + x, contentLength - x, [](const just_block_masks* masks) { return masks->open | masks->close | masks->quote | masks->comment; });
+        if (x >= contentLength)
+            break;
+
+        if (char_side[x] == just_syntax.just_format_string) {
+            if (!(y = just_scan_string(char_side + x, contentLength - x, &escaped))) {
+                endpoint = x;
+                break;
+            }
+            x += y + 1;
+        } else if (char_side[x] == *just_syntax.just_commentLine) {
+            x += just_is_comment_line(char_side + x, contentLength - x) ? just_has_eol(scan, char_side + x, contentLength - x) : 1;
+        } else {
+            endpoint = x;
+            break;
+        }
+    }
+    return true;
+}
+
+// Find bounds of the top-level blocks: cut after a block is closed on depth 0 (strings and comments is skipped).
+// bounds: first is 0, last is length, pieces is not shorter than minimum (except last)
+method void just_split_blocks(const char* source, jnumber length, jnumber minimum, std::vector<jnumber>& bounds)
+{
+    int y, window;
+    int depth = 0;
+    jbool escaped;
+    jnumber x = 0;
+    just_scan_index content = just_scan_content(source, length);
+    just_scan_index* scan = &content;
+
+    bounds.assign(1, 0);
+    while (x < length) {
+        window = static_cast<int>(std::min<jnumber>(length - x, INT_MAX));
+        y = just_scan_first(scan, source + x, window, [](const just_block_masks* masks) { return masks->open | masks->close | masks->quote | masks->comment; });
+        x += y;
+        if (y == window)
+            continue;
+
+        if (source[x] == just_syntax.just_format_string) {
+            // unclosed string is reported by parser
+            if (!(y = just_scan_string(source + x, window - y, &escaped)))
+                break;
+            x += y + 1;
+        } else if (source[x] == *just_syntax.just_commentLine) {
+            x += just_is_comment_line(source + x, window - y) ? just_has_eol(scan, source + x, window - y) : 1;
+        } else if (source[x] == *just_syntax.just_block_segments) {
+            ++depth;
+            ++x;
+        } else {
+            // Error: tree is not opened, it is reported by parser (one block)
+            if (--depth < 0) {
+                bounds.clear();
+                return;
+            }
+            ++x;
+            if (!depth && x - bounds.back() >= minimum && x < length)
+                bounds.push_back(x);
+        }
+    }
+    bounds.push_back(length);
+}
+
+// End of the block (position of the closing brace), source is started by opening brace. -1: block is not closed.
+// Strings and comments is skipped, it is brace prescan by masks (see. just_split_blocks)
+method jnumber just_block_end(just_scan_index* scan, const char* source, jnumber length)
+{
+    int y, window;
+    int depth = 0;
+    jbool escaped;
+    jnumber x = 0;
+
+    while (x < length) {
+        window = static_cast<int>(std::min<jnumber>(length - x, INT_MAX));
+        y = just_scan_first(scan, source + x, window, [](const just_block_masks* masks) { return masks->open | masks->close | masks->quote | masks->comment; });
+        x += y;
+        if (y == window)
+            continue;
+
+        if (source[x] == just_syntax.just_format_string) {
+            if (!(y = just_scan_string(source + x, window - y, &escaped)))
+                return -1;
+            x += y + 1;
+        } else if (source[x] == *just_syntax.just_commentLine) {
+            x += just_is_comment_line(source + x, window - y) ? just_has_eol(scan, source + x, window - y) : 1;
+        } else if (source[x] == *just_syntax.just_block_segments) {
+            ++depth;
+            ++x;
+        } else {
+            if (!--depth)
+                return x;
+            ++x;
+        }
+    }
+    return -1;
+}
+
+// Just Object Node
+
+// Node of the handle: handle is index of the node (see. just_object_parser::get_node), it is kept when nodes is moved
+method inline const jnode_t* just_storage_node(const just_storage* pstore, std::uint32_t handle) { return pstore->nodes + handle; }
+
+static_assert(std::is_trivially_copyable<just_object_node>::value, "node is handle, it is copied by value");
+
+just_object_node::just_object_node(just_object_parser* owner, std::uint32_t node)
+{
+    this->_jowner = owner;
+    this->_jhead = node;
+}
+
+method JustType just_object_node::type() const { return just_ipt_type(just_storage_node(static_cast<const just_storage*>(_jowner->_storage), _jhead)->value); }
+
+method just_object_node* just_object_node::tree(const jstring& child)
+{
+    just_storage* pstore = static_cast<just_storage*>(_jowner->_storage);
+    const jnode_t* pnode;
+    // lazy document: tree is parsed on first access
+    just_storage_materialize(pstore, just_storage_node(pstore, _jhead)->value);
+    pnode = just_storage_find_node(pstore, just_storage_node(pstore, _jhead)->value, child.data(), static_cast<int>(child.size()));
+    return pnode ? _jowner->get_node(pnode) : nullptr;
+}
+
+method jbool just_object_node::has_tree() const { return type() == JustType::JustTree; }
+
+method jbool just_object_node::has_value() const
+{
+    JustType jtype = type();
+    return jtype > JustType::Null && jtype < JustType::JustTree;
+}
+
+jstring just_object_node::to_string() const
+{
+    JustType type;
+    const void* value = get_value(&type);
+    switch (type) {
+    case JustType::JustString: {
+        const just_string_t* str = static_cast<const just_string_t*>(value);
+        return jstring(just_storage_get_chars(static_cast<const just_storage*>(_jowner->_storage), str), str->length);
+    }
+    case JustType::JustNumber:
+        return std::to_string(*static_cast<const jnumber*>(value));
+    case JustType::JustBoolean:
+        return std::to_string(*static_cast<const jbool*>(value));
+    case JustType::JustReal: {
+        // shortest round-trip
+        jstring real;
+        just_write_real(real, *static_cast<const jreal*>(value));
+        return real;
+    }
+    case JustType::JustTree:
+    case JustType::Unknown:
+        return jstring(just_syntax.just_unknown_string);
+    case JustType::Null:
+        return jstring(just_syntax.just_null_string);
+    }
+    return {};
+}
+
+method const void* just_object_node::get_span(JustType type, std::size_t* size) const
+{
+    jnumber length;
+    just_storage* pstore = static_cast<just_storage*>(_jowner->_storage);
+    int value = just_storage_node(pstore, _jhead)->value;
+    // pending array (lazy document)
+    just_storage_materialize(pstore, value);
+    const void* elements = just_storage_get_span(pstore, value, type, &length);
+    if (!elements)
+        throw std::bad_cast();
+    *size = static_cast<std::size_t>(length);
+    return elements;
+}
+
+method void just_object_node::set_value(const just_value& value)
+{
+    just_storage* pstore = static_cast<just_storage*>(_jowner->edit());
+    int ipt = just_storage_node(pstore, _jhead)->value;
+    int tree = just_ipt_make(JustType::JustTree, pstore->owners[_jhead]);
+    JustType type = just_ipt_type(ipt);
+
+    just_storage_touch(pstore, tree);
+    // fixed size value of the same type (elements of array is kept in a row)
+    if (type == value._type && type >= JustType::JustBoolean && type <= JustType::JustReal) {
+        std::memcpy(just_storage_get_pointer(pstore, ipt), value.data(), just_type_size(type));
+        return;
+    }
+    if (type == JustType::JustTree) {
+        just_storage_release_tree(pstore, ipt);
+        _jowner->changed();
+    }
+    // previous value is not used (string is shared by interning)
+    ipt = just_storage_alloc_value(pstore, value._type, value.data(), value._length);
+    if (value._type == JustType::JustTree)
+        pstore->rows[just_ipt_index(ipt)].parent = just_ipt_index(tree);
+    const_cast<jnode_t*>(just_storage_node(pstore, _jhead))->value = ipt;
+    // element of the array: values of one type is kept in a row (see. as_span)
+    if (just_storage_node(pstore, _jhead)->name == Invalid_IPT)
+        just_storage_arrange_row(pstore, tree);
+}
+
+method just_object_node* just_object_node::add_child(const jstring& name, const just_value& value) { return _jowner->insert_node(just_storage_node(static_cast<just_storage*>(_jowner->_storage), _jhead)->value, &name, value); }
+
+method just_object_node* just_object_node::append(const just_value& value) { return _jowner->insert_node(just_storage_node(static_cast<just_storage*>(_jowner->_storage), _jhead)->value, nullptr, value); }
+
+method jbool just_object_node::remove_child(const jstring& name) { return _jowner->remove_node(just_storage_node(static_cast<just_storage*>(_jowner->_storage), _jhead)->value, name); }
+
+just_object_node::operator jnumber() const { return get_int(); }
+
+just_object_node::operator jbool() const { return get_bool(); }
+
+just_object_node::operator jreal() const { return get_real(); }
+
+just_object_node::operator jstring() const { return get_str(); }
+
+method const jstring just_object_node::name() const
+{
+    const just_storage* pstore = static_cast<const just_storage*>(_jowner->_storage);
+    int name = just_storage_node(pstore, _jhead)->name;
+    if (name == Invalid_IPT)
+        // element of array
+        return {};
+    const just_string_t* str = static_cast<const just_string_t*>(just_storage_get_pointer(pstore, name));
+    return jstring(just_storage_get_chars(pstore, str), str->length);
+}
+
+// method for count value in statistics
+method inline void just_avail_stat(just_stats* jstat, JustType valueType, int length)
+{
+    switch (valueType) {
+    case JustType::JustString:
+        ++jstat->jstrings;
+        // without quotes, with null-terminator
+        jstat->jstrings_total_bytes += length - 1;
+        break;
+    case JustType::JustBoolean:
+        ++jstat->jbools;
+        break;
+    case JustType::JustReal:
+        ++jstat->jreals;
+        break;
+    case JustType::JustNumber:
+        ++jstat->jnumbers;
+        break;
+    }
+}
+
+// warnings of the document (see. JustDiagnostic::Warning)
+static const char Warning_MixedArray[] = "array has elements of different types";
+
+// Send message to the diagnostics sink (see. just_trace), position - in the source
+method void just_trace_emit(const just_tracer* tracer, JustDiagnostic level, JustEvent event, JustType type, int depth, const char* position, const char* chars, int length)
+{
+    just_diagnostic message;
+    message.level = level;
+    message.event = event;
+    message.type = type;
+    message.array = false;
+    message.depth = depth;
+    message.offset = position - tracer->origin;
+    message.chars = chars;
+    message.length = length;
+    if (event == JustEvent::BeginTree && type == JustType::Unknown) {
+        // array (see. just_avail)
+        message.type = JustType::JustTree;
+        message.array = true;
+    }
+
+    if (tracer->lock) {
+        std::lock_guard<std::mutex> guard(*tracer->lock);
+        (*tracer->sink)(message);
+    } else
+        (*tracer->sink)(message);
+}
+
+// Elements of the array (without names) from x to z (closing brace), nodes is appended.
+// depth: opened trees for diagnostics (see. just_trace)
+method just_fault just_avail_array(just_storage** pstore, just_stats* jstat, just_scan_index* scan, const char* pointer, int x, int z, std::vector<jnode_t>& nodes, const just_tracer* tracer, int depth)
+{
+    int y, value;
+    JustType valueType;
+    JustType current_block_type = JustType::Unknown;
+
+#define push_node(name, value) (nodes.push_back({ name, value }))
+#define fault(kind, position, expected) return just_fault { JustParseCode::kind, (position), (expected) }
+
+    // While end of array length
+    while (x < z) {
+        x += just_autoskip_comment(scan, pointer + x, z - x);
+        if (x >= z)
+            break;
+        // next index
+        if (pointer[x] == just_syntax.just_obstacle) {
+            ++x;
+            continue;
+        }
+
+        x += y = just_get_format(pointer + x, z - x, pstore, valueType, &value);
+        if (valueType == JustType::Unknown && pointer[x] == just_syntax.just_format_string)
+            fault(UnclosedString, pointer + x, "closing quote");
+        if (valueType <= JustType::Null)
+            fault(InvalidValue, pointer + x, "array element");
+
+        if (current_block_type == JustType::Unknown) {
+            current_block_type = valueType;
+            if (jstat) {
+                switch (current_block_type) {
+                case JustType::JustString:
+                    ++jstat->jarrstrings;
+                    break;
+                case JustType::JustBoolean:
+                    ++jstat->jarrbools;
+                    break;
+                case JustType::JustReal:
+                    ++jstat->jarrreals;
+                    break;
+                case JustType::JustNumber:
+                    ++jstat->jarrnumbers;
+                    break;
+                }
+            }
+        }
+
+        else if (valueType != current_block_type)
+            just_trace(tracer, JustDiagnostic::Warning, JustEvent::ArrayElement, valueType, depth, pointer + x - y, Warning_MixedArray, sizeof(Warning_MixedArray) - 1);
+
+        if (jstat)
+            just_avail_stat(jstat, valueType, y);
+        just_trace(tracer, JustDiagnostic::Trace, JustEvent::ArrayElement, valueType, depth, pointer + x - y, pointer + x - y, y);
+
+        // element of array (without name)
+        push_node(Invalid_IPT, value);
+    }
+
+    return just_fault { JustParseCode::Ok, nullptr, nullptr };
+
+#undef fault
+#undef push_node
+}
+
+// Single pass avail (evaluate) the source.
+// storage is set : vaults and trees are built in one sweep
+// storage is null: collect only statistics (see. just_storage_reserve)
+// tracer: diagnostics of the parse (see. just_trace), can be null
+// tree: the tree is filled by nodes of the source (Invalid_IPT - new root tree)
+// lazy storage: trees of the filled tree is pending, the content is skipped (see. just_storage_materialize)
+// returns fault of the syntax (JustParseCode::Ok - source is valid), without exception
+method just_fault just_avail(just_storage** pstore, just_stats* jstat, const char* source, int length, const just_tracer* tracer, int tree)
+{
+    int x, y, z;
+    int name, value;
+    JustType valueType;
+    just_fault result;
+    std::vector<jnode_t> nodes; // nodes of the opened trees
+    std::vector<std::pair<int, std::size_t>> stack; // opened trees: IPT and first node
+    const char* pointer = source;
+    just_scan_index content = just_scan_content(source, length);
+    just_scan_index* scan = &content;
+
+#define push_node(name, value) (nodes.push_back({ name, value }))
+#define fault(kind, position, expected) return just_fault { JustParseCode::kind, (position), (expected) }
+#define commit_tree(ipt, first)                                                                                    \
+    do {                                                                                                           \
+        if (pstore)                                                                                                \
+            just_storage_commit_tree(pstore, ipt, nodes.data() + (first), static_cast<int>(nodes.size() - (first))); \
+        if (jstat) {                                                                                               \
+            ++jstat->jtrees;                                                                                       \
+            jstat->jnodes += nodes.size() - (first);                                                               \
+        }                                                                                                          \
+        nodes.resize(first);                                                                                       \
+    } while (0)
+
+    // root tree
+    stack.emplace_back(tree != Invalid_IPT ? tree : pstore ? just_storage_alloc_tree(pstore) : Invalid_IPT, 0);
+
+    for (x = 0;;) {
+        // has comment line
+        x += just_autoskip_comment(scan, pointer + x, length - x);
+        if (x >= length || pointer[x] == '\0')
+            break;
+
+        // separator of the nodes
+        if (pointer[x] == just_syntax.just_obstacle) {
+            ++x;
+            continue;
+        }
+
+        // end of the tree
+        if (pointer[x] == just_syntax.just_block_segments[1]) {
+            if (stack.size() == 1)
+                // Error: tree is not opened
+                fault(UnopenedTree, pointer + x, "property name");
+            commit_tree(stack.back().first, stack.back().second);
+            stack.pop_back();
+            just_trace(tracer, JustDiagnostic::Trace, JustEvent::EndTree, JustType::JustTree, static_cast<int>(stack.size() - 1), pointer + x, pointer + x, 1);
+            ++x;
+            continue;
+        }
+
+        y = x;
+        x += just_skip(scan, pointer + x, length - x);
+
+        // Preparing, check property name
+        if (!just_valid_property_name(pointer + y, x - y))
+            fault(InvalidName, pointer + y, "property name");
+
+        // property name
+        name = Invalid_IPT;
+        if (pstore) {
+            if ((*pstore)->source)
+                just_storage_alloc_string_ref(pstore, pointer + y, x - y);
+            else
+                std::memcpy(just_storage_alloc_field(pstore, JustType::JustString, x - y), pointer + y, x - y);
+            name = just_storage_intern(*pstore);
+        }
+        if (jstat)
+            just_avail_stat(jstat, JustType::JustString, x - y + 2);
+        just_trace(tracer, JustDiagnostic::Trace, JustEvent::PropertyName, JustType::JustString, static_cast<int>(stack.size() - 1), pointer + y, pointer + y, x - y);
+
+        // has comment line
+        x += just_autoskip_comment(scan, pointer + x, length - x);
+        if (x >= length)
+            fault(UnexpectedEnd, pointer + length, "value");
+
+        // is block or array
+        if (pointer[x] == *just_syntax.just_block_segments) {
+            if (just_is_array(scan, pointer + x, z, length - x)) {
+                if (z < 0)
+                    fault(UnclosedTree, pointer + length, "'}'");
+                z += x;
+                if (pointer[z] == *just_syntax.just_block_segments)
+                    fault(InvalidValue, pointer + z, "array element");
+                if (pointer[z] == just_syntax.just_format_string)
+                    fault(UnclosedString, pointer + z, "closing quote");
+                if (pstore && (*pstore)->lazy && stack.size() == 1) { // pending array, elements is parsed on access
+                    value = just_storage_alloc_tree(pstore);
+                    (*pstore)->lazy[just_ipt_index(value)] = { pointer + x + 1 - (*pstore)->source, pointer + z - (*pstore)->source, true };
+                    push_node(name, value);
+                    x = z + 1;
+                    continue;
+                }
+                just_trace(tracer, JustDiagnostic::Trace, JustEvent::BeginTree, JustType::Unknown, static_cast<int>(stack.size() - 1), pointer + x, pointer + x, 1);
+                stack.emplace_back(pstore ? just_storage_alloc_tree(pstore) : Invalid_IPT, nodes.size());
+                result = just_avail_array(pstore, jstat, scan, pointer, x + 1, z, nodes, tracer, static_cast<int>(stack.size() - 1));
+                if (result.code != JustParseCode::Ok)
+                    return result;
+
+                value = stack.back().first;
+                commit_tree(value, stack.back().second);
+                stack.pop_back();
+                push_node(name, value);
+                just_trace(tracer, JustDiagnostic::Trace, JustEvent::EndTree, JustType::JustTree, static_cast<int>(stack.size() - 1), pointer + z, pointer + z, 1);
+                x = z + 1;
+            } else if (pstore && (*pstore)->lazy && stack.size() == 1) { // pending tree, content is parsed on access
+                jnumber end = just_block_end(scan, pointer + x, length - x);
+                if (end < 0)
+                    fault(UnclosedTree, pointer + length, "'}'");
+                value = just_storage_alloc_tree(pstore);
+                (*pstore)->lazy[just_ipt_index(value)] = { pointer + x + 1 - (*pstore)->source, pointer + x + end - (*pstore)->source, false };
+                push_node(name, value);
+                x += static_cast<int>(end) + 1;
+            } else { // enter the next node
+                value = pstore ? just_storage_alloc_tree(pstore) : Invalid_IPT;
+                push_node(name, value);
+                just_trace(tracer, JustDiagnostic::Trace, JustEvent::BeginTree, JustType::JustTree, static_cast<int>(stack.size() - 1), pointer + x, pointer + x, 1);
+                stack.emplace_back(value, nodes.size());
+                if (jstat && static_cast<jnumber>(stack.size() - 1) > jstat->jdepths)
+                    jstat->jdepths = stack.size() - 1;
+                ++x;
+            }
+        } else { // get also value
+            x += y = just_get_format(pointer + x, length - x, pstore, valueType, &value);
+            if (valueType == JustType::Unknown && pointer[x] == just_syntax.just_format_string)
+                fault(UnclosedString, pointer + x, "closing quote");
+            if (valueType <= JustType::Null)
+                fault(InvalidValue, pointer + x, "value");
+
+            if (jstat)
+                just_avail_stat(jstat, valueType, y);
+            just_trace(tracer, JustDiagnostic::Trace, JustEvent::Value, valueType, static_cast<int>(stack.size() - 1), pointer + x - y, pointer + x - y, y);
+
+            push_node(name, value);
+        }
+    }
+
+    if (stack.size() != 1)
+        // Error: Line in require end depth
+        fault(UnclosedTree, pointer + std::min(x, length), "'}'");
+
+    commit_tree(stack.back().first, 0);
+    return just_fault { JustParseCode::Ok, nullptr, nullptr };
+
+#undef fault
+#undef push_node
+#undef commit_tree
+}
+
+// characters of the snippet by side from the error (see. just_parse_error)
+enum { Snippet_Side = 40 };
+
+just_parse_error::just_parse_error()
+    : just_parse_error(JustParseCode::Ok, 0, "")
+{
+}
+
+just_parse_error::just_parse_error(JustParseCode code, jnumber offset, const char* expected, const char* source, std::size_t length)
+    : _code(code)
+    , _offset(offset)
+    , _line(0)
+    , _column(0)
+    , _expected(expected)
+{
+    const char* first;
+    const char* last;
+    const char* position;
+    std::ostringstream message;
+
+    if (source && offset >= 0 && static_cast<std::size_t>(offset) <= length) {
+        // line and column by count of the lines before (on failure only)
+        position = source + offset;
+        first = source;
+        for (const char* eol; (eol = static_cast<const char*>(std::memchr(first, '\n', position - first))); first = eol + 1)
+            ++_line;
+        ++_line;
+        _column = static_cast<int>(std::min<jnumber>(position - first + 1, INT_MAX));
+
+        // snippet: line of the error, limited by side
+        if (!(last = static_cast<const char*>(std::memchr(position, '\n', source + length - position))))
+            last = source + length;
+        first = std::max(first, position - std::min<jnumber>(position - source, Snippet_Side));
+        last = std::min(last, position + Snippet_Side);
+        while (last > first && (last[-1] == '\r' || last[-1] == '\0'))
+            --last;
+        _snippet.assign(first, last);
+    }
+
+    if (code == JustParseCode::Ok)
+        message << "no error";
+    else {
+        message << "syntax error at ";
+        if (_line)
+            message << "line " << _line << ", column " << _column;
+        else
+            message << "offset " << _offset;
+        message << ": expected " << _expected;
+        if (!_snippet.empty())
+            message << " near \"" << _snippet << '"';
+    }
+    _message = message.str();
+}
+
+method JustParseCode just_parse_error::code() const { return _code; }
+
+method jnumber just_parse_error::offset() const { return _offset; }
+
+method int just_parse_error::line() const { return _line; }
+
+method int just_parse_error::column() const { return _column; }
+
+method const char* just_parse_error::expected() const { return _expected; }
+
+method const jstring& just_parse_error::snippet() const { return _snippet; }
+
+method const char* just_parse_error::what() const noexcept { return _message.c_str(); }
+
+// Reader states (see. just_reader::next)
+enum { Reader_Name = 0, Reader_Value = 1, Reader_Element = 2 };
+
+// Reader result of the step
+enum { Reader_Done = 0, Reader_More = -1, Reader_Invalid = -2 };
+
+// method for skip spaces and comments in the part of input
+// complete is false: comment is not ended in the part, required more characters
+method int just_reader_skip(just_scan_index* scan, const char* char_side, int length, bool finished, bool* complete)
+{
+    int x = 0, y;
+    *complete = true;
+    for (;;) {
+        x += just_trim(scan, char_side + x, length - x);
+        if (x >= length || !just_is_comment_line(char_side + x, length - x))
+            break;
+        y = x + just_has_eol(scan, char_side + x, length - x);
+        if (y >= length && !finished) {
+            // comment is continued in the next part
+            *complete = false;
+            break;
+        }
+        x = y;
+    }
+    return x;
+}
+
+// method for read value of the reader event, return length or Reader_More, Reader_Invalid
+method int just_reader_value(just_scan_index* scan, const char* char_side, int length, bool finished, just_event* event, jstring* scratch)
+{
+    int offset;
+    jbool escaped;
+
+    if (*char_side == just_syntax.just_format_string) {
+        if (!(offset = just_scan_string(char_side, length, &escaped)))
+            return finished ? Reader_Invalid : Reader_More;
+        event->type = JustType::JustString;
+        event->chars = char_side + 1;
+        event->length = offset - 1;
+        if (escaped) {
+            scratch->resize(just_unescape(event->chars, event->length, nullptr));
+            event->length = just_unescape(event->chars, event->length, &(*scratch)[0]);
+            event->chars = scratch->data();
+        }
+        return offset + 1;
+    }
+
+    // value is ended by separator (see. just_scan_number, just_is_jbool)
+    if (!finished && just_scan_first(scan, char_side, length, [](const just_block_masks* masks) { return masks->space | masks->open | masks->close | masks->obstacle | masks->eol; }) >= length)
+        return Reader_More;
+
+    if ((offset = just_scan_number(char_side, length, &event->type, &event->number, &event->real)))
+        return offset;
+
+    if (just_is_jbool(char_side, length, &offset)) {
+        event->type = JustType::JustBoolean;
+        event->boolean = (offset == sizeof(just_syntax.just_true_string) - 1);
+        return offset;
+    }
+
+    return Reader_Invalid;
+}
+
+just_reader::just_reader()
+    : _offset(0)
+    , _position(0)
+    , _state(Reader_Name)
+    , _finished(false)
+{
+}
+
+method void just_reader::feed(const char* chunk, std::size_t length)
+{
+    if (_finished)
+        throw std::logic_error("reader is finished");
+    // release consumed characters, the tail of the token is kept
+    _position += _offset;
+    _buffer.erase(0, _offset);
+    _offset = 0;
+    _buffer.append(chunk, length);
+}
+
+method void just_reader::finish() { _finished = true; }
+
+method bool just_reader::next(just_event& event)
+{
+    int x, y;
+    bool complete;
+    const char* pointer;
+    int length;
+    // content is not changed until next feed
+    just_scan_index scan = just_scan_content(_buffer.data() + _offset, _buffer.size() - _offset);
+
+    for (;;) {
+        pointer = _buffer.data() + _offset;
+        length = static_cast<int>(std::min<std::size_t>(_buffer.size() - _offset, INT_MAX));
+
+        // has comment line
+        _offset += x = just_reader_skip(&scan, pointer, length, _finished, &complete);
+        if (!complete)
+            return false;
+        pointer += x;
+        length -= x;
+
+        if (length == 0 || *pointer == '\0') {
+            if (_finished && _state == Reader_Value)
+                throw just_parse_error(JustParseCode::UnexpectedEnd, _position + _offset, "value");
+            if (_finished && _stack.size())
+                // Error: Line in require end depth
+                throw just_parse_error(JustParseCode::UnclosedTree, _position + _offset, "'}'");
+            return false;
+        }
+
+        event = {};
+        event.depth = static_cast<int>(_stack.size());
+
+        // separator of the nodes
+        if (*pointer == just_syntax.just_obstacle && _state != Reader_Value) {
+            ++_offset;
+            continue;
+        }
+
+        // end of the tree
+        if (*pointer == just_syntax.just_block_segments[1] && _state != Reader_Value) {
+            if (_stack.empty())
+                // Error: tree is not opened
+                throw just_parse_error(JustParseCode::UnopenedTree, _position + _offset, "property name");
+            event.event = JustEvent::EndTree;
+            event.type = JustType::JustTree;
+            event.array = _stack.back();
+            event.depth = static_cast<int>(_stack.size()) - 1;
+            _stack.pop_back();
+            _state = Reader_Name;
+            ++_offset;
+            return true;
+        }
+
+        switch (_state) {
+        case Reader_Name:
+            x = just_skip(&scan, pointer, length);
+            if (x >= length && !_finished)
+                return false;
+            // Preparing, check property name
+            if (!just_valid_property_name(pointer, x))
+                throw just_parse_error(JustParseCode::InvalidName, _position + _offset, "property name");
+            event.event = JustEvent::PropertyName;
+            event.chars = pointer;
+            event.length = x;
+            _offset += x;
+            _state = Reader_Value;
+            return true;
+
+        case Reader_Value:
+            if (*pointer == *just_syntax.just_block_segments) {
+                // is block or array: array starts with value or is empty
+                just_event first;
+                x = 1 + just_reader_skip(&scan, pointer + 1, length - 1, _finished, &complete);
+                if (!complete || (x >= length && !_finished))
+                    return false;
+                if (x < length && pointer[x] == just_syntax.just_block_segments[1])
+                    event.array = true;
+                else if (x < length) {
+                    y = just_reader_value(&scan, pointer + x, length - x, _finished, &first, &_scratch);
+                    if (y == Reader_More)
+                        return false;
+                    event.array = y > 0;
+                }
+                event.event = JustEvent::BeginTree;
+                event.type = JustType::JustTree;
+                _stack.push_back(event.array);
+                _state = event.array ? Reader_Element : Reader_Name;
+                ++_offset;
+                return true;
+            }
+            // get also value
+            event.event = JustEvent::Value;
+            _state = Reader_Name;
+            break;
+
+        case Reader_Element:
+            // element of array (without name)
+            event.event = JustEvent::ArrayElement;
+            break;
+        }
+
+        x = just_reader_value(&scan, pointer, length, _finished, &event, &_scratch);
+        if (x == Reader_More) {
+            _state = event.event == JustEvent::Value ? Reader_Value : Reader_Element;
+            return false;
+        }
+        if (x == Reader_Invalid) {
+            if (*pointer == just_syntax.just_format_string)
+                throw just_parse_error(JustParseCode::UnclosedString, _position + _offset, "closing quote");
+            throw just_parse_error(JustParseCode::InvalidValue, _position + _offset, event.event == JustEvent::Value ? "value" : "array element");
+        }
+        _offset += x;
+        return true;
+    }
+}
+
+method void just_reader::read(std::istream& stream, const std::function<void(const just_event&)>& handler, std::size_t chunkSize)
+{
+    just_reader reader;
+    just_event event;
+    std::vector<char> chunk(chunkSize ? chunkSize : 1);
+
+    while (stream) {
+        stream.read(chunk.data(), chunk.size());
+        reader.feed(chunk.data(), static_cast<std::size_t>(stream.gcount()));
+        while (reader.next(event))
+            handler(event);
+    }
+    reader.finish();
+    while (reader.next(event))
+        handler(event);
+}
+
+// size of the chunk for large source (see. just_object_parser::deserialize)
+static const std::size_t Deserialize_Chunk = 1 << 24;
+
+// pieces per thread (see. deserialize_parallel), piece is not shorter than Parallel_MinPiece
+enum : jnumber { Parallel_Pieces = 4, Parallel_MinPiece = 1 << 20 };
+
+// state of the incremental deserialization (see. just_object_parser::begin)
+struct just_incremental {
+    just_reader reader;
+    std::vector<jnode_t> nodes; // nodes of the opened trees
+    std::vector<std::pair<int, std::size_t>> stack; // opened trees: IPT and first node
+    int name = Invalid_IPT; // name of the next value or tree
+};
+
+// Build storage from events of the reader (available part of the input)
+method void just_incremental_build(just_storage** pstore, just_incremental* state)
+{
+    int value;
+    just_event event;
+
+    while (state->reader.next(event)) {
+        switch (event.event) {
+        case JustEvent::PropertyName:
+            std::memcpy(just_storage_alloc_field(pstore, JustType::JustString, event.length), event.chars, event.length);
+            state->name = just_storage_intern(*pstore);
+            break;
+
+        case JustEvent::BeginTree:
+            // enter the next node
+            value = just_storage_alloc_tree(pstore);
+            state->nodes.push_back({ state->name, value });
+            state->stack.emplace_back(value, state->nodes.size());
+            break;
+
+        case JustEvent::EndTree:
+            just_storage_commit_tree(pstore, state->stack.back().first, state->nodes.data() + state->stack.back().second, static_cast<int>(state->nodes.size() - state->stack.back().second));
+            state->nodes.resize(state->stack.back().second);
+            state->stack.pop_back();
+            break;
+
+        case JustEvent::Value:
+        case JustEvent::ArrayElement:
+            value = Invalid_IPT;
+            switch (event.type) {
+            case JustType::JustString:
+                std::memcpy(just_storage_alloc_field(pstore, event.type, event.length), event.chars, event.length);
+                value = just_storage_intern(*pstore);
+                break;
+            case JustType::JustNumber:
+                std::memcpy(just_storage_alloc_field(pstore, event.type), &event.number, sizeof(event.number));
+                break;
+            case JustType::JustReal:
+                std::memcpy(just_storage_alloc_field(pstore, event.type), &event.real, sizeof(event.real));
+                break;
+            default:
+                std::memcpy(just_storage_alloc_field(pstore, event.type), &event.boolean, sizeof(event.boolean));
+                break;
+            }
+            if (value == Invalid_IPT)
+                value = just_ipt_make(event.type, (&(*pstore)->numBools)[static_cast<int>(event.type) - 1] - 1);
+            // element of array (without name)
+            state->nodes.push_back({ event.event == JustEvent::Value ? state->name : Invalid_IPT, value });
+            break;
+        }
+    }
+}
+
+// node objects per page of the entry (see. just_object_parser::get_node)
+enum : jnumber { Entry_PageShift = 12, Entry_PageSize = 1 << Entry_PageShift };
+
+// Release pages of the node objects and directory
+method void just_entry_free(std::atomic<just_object_node*>* entry, jnumber pages)
+{
+    for (jnumber x = 0; x < pages; ++x)
+        std::free(entry[x].load(std::memory_order_relaxed));
+    std::free(entry);
+}
+
+// Directory of the node pages is grown (pages is kept), new pages is empty
+method std::atomic<just_object_node*>* just_entry_grow(std::atomic<just_object_node*>* entry, jnumber pages, jnumber newPages)
+{
+    std::atomic<just_object_node*>* directory = static_cast<std::atomic<just_object_node*>*>(std::malloc(std::max<jnumber>(newPages, 1) * sizeof(std::atomic<just_object_node*>)));
+    if (!directory)
+        throw std::bad_alloc();
+    for (jnumber x = 0; x < newPages; ++x)
+        new (directory + x) std::atomic<just_object_node*>(x < pages ? entry[x].load(std::memory_order_relaxed) : nullptr);
+    std::free(entry);
+    return directory;
+}
+
+// generation of the documents, unique for all parsers (see. just_path)
+static std::atomic<jnumber> just_generations(0);
+
+just_object_parser::just_object_parser()
+    : just_object_parser::just_object_parser(JustAllocationMethod::dynamic_allocation)
+{
+}
+
+just_object_parser::just_object_parser(JustAllocationMethod allocationMethod)
+    : _storage(nullptr)
+    , entry(nullptr)
+    , entryPages(0)
+    , _allocationMethod(allocationMethod)
+    , _mapping(nullptr)
+    , _mappingLength(0)
+    , _generation(0)
+    , _incremental(nullptr)
+    , _diagnosticLevel(JustDiagnostic::Off)
+    , _frozen(false)
+{
+}
+
+just_object_parser::~just_object_parser()
+{
+    just_storage_deinit(static_cast<just_storage*>(_storage));
+    just_entry_free(entry, entryPages);
+    delete static_cast<just_incremental*>(_incremental);
+    system_unmap_file(_mapping, _mappingLength);
+}
+
+method void just_object_parser::deserialize_from(const jstring& filename, JustLoadMethod loadMethod, unsigned threads)
+{
+    jnumber length;
+    char* buffer;
+    std::ifstream file;
+
+    if (loadMethod == JustLoadMethod::memory_map || loadMethod == JustLoadMethod::lazy_map) {
+        jnumber mappingLength;
+        void* mapping = system_map_file(filename.c_str(), &mappingLength);
+        void* lastMapping = _mapping;
+        jnumber lastMappingLength = _mappingLength;
+        jnumber lastGeneration = _generation;
+
+        _mapping = mapping;
+        _mappingLength = mappingLength;
+        try {
+            // deserialize on mapped pages, storage refer to mapping
+            if (loadMethod == JustLoadMethod::lazy_map)
+                deserialize_lazy(static_cast<const char*>(mapping), static_cast<std::size_t>(mappingLength));
+            else if (threads != 1)
+                deserialize_parallel(static_cast<const char*>(mapping), static_cast<std::size_t>(mappingLength), threads);
+            else
+                deserialize(static_cast<const char*>(mapping), static_cast<std::size_t>(mappingLength));
+        } catch (...) {
+            if (_generation == lastGeneration) {
+                // storage is not released (see. prepare), it refer to the previous file
+                _mapping = lastMapping;
+                _mappingLength = lastMappingLength;
+            } else {
+                // previous storage is released, unmap the previous file also
+                _mapping = nullptr;
+                _mappingLength = 0;
+                system_unmap_file(lastMapping, lastMappingLength);
+            }
+            system_unmap_file(mapping, mappingLength);
+            throw;
+        }
+        // previous storage is released, unmap the previous file
+        system_unmap_file(lastMapping, lastMappingLength);
+        return;
+    }
+
+    // try open file
+    file.open(filename, std::ios::binary);
+
+    // has error from open
+    if (!file)
+        throw std::runtime_error("error open file");
+
+    // read length
+    length = file.seekg(0, std::ios::end).tellg();
+    file.seekg(0, std::ios::beg);
+
+    // check buffer
+    if ((buffer = (char*)malloc(length + 1)) == nullptr)
+        throw std::bad_alloc();
+
+    // read
+    length = file.read(buffer, length).gcount();
+    buffer[length] = '\0';
+    // close file
+    file.close();
+
+    // deserialize
+    try {
+        if (threads != 1)
+            deserialize_parallel(buffer, static_cast<std::size_t>(length), threads);
+        else
+            deserialize((char*)buffer, static_cast<std::size_t>(length));
+    } catch (...) {
+        free(buffer);
+        throw;
+    }
+    // free buffer
+    free(buffer);
+}
+// Parse content of the pending tree (lazy document), trees of it is pending also. Parsed tree is indexed.
+method void just_storage_materialize(just_storage* pstore, int tree)
+{
+    just_fault fault;
+    just_lazy_block block;
+
+    if (!pstore->lazy || just_ipt_type(tree) != JustType::JustTree || !(block = pstore->lazy[just_ipt_index(tree)]).begin)
+        return;
+
+    if (block.array) {
+        std::vector<jnode_t> nodes;
+        just_scan_index scan = just_scan_content(pstore->source, block.end);
+        fault = just_avail_array(&pstore, nullptr, &scan, pstore->source, static_cast<int>(block.begin), static_cast<int>(block.end), nodes, nullptr, 0);
+        if (fault.code == JustParseCode::Ok)
+            just_storage_commit_tree(&pstore, tree, nodes.data(), static_cast<int>(nodes.size()));
+    } else
+        fault = just_avail(&pstore, nullptr, pstore->source + block.begin, static_cast<int>(block.end - block.begin), nullptr, tree);
+    // tables of the new trees (error also)
+    just_storage_index_tree(pstore, tree);
+    if (fault.code != JustParseCode::Ok)
+        // the tree is pending, error is repeated on next access
+        throw just_parse_error(fault.code, fault.position - pstore->source, fault.expected, pstore->source, pstore->sourceLength);
+    pstore->lazy[just_ipt_index(tree)].begin = 0;
+}
+
+// Parse all pending trees (lazy document), new trees is after parsed
+method void just_storage_materialize_all(just_storage* pstore)
+{
+    if (pstore == nullptr || pstore->lazy == nullptr)
+        return;
+    for (jnumber x = 0; x < pstore->numTrees; ++x)
+        just_storage_materialize(pstore, just_ipt_make(JustType::JustTree, x));
+}
+
+// Build storage from the source, fixed: presize storage from statistics, tracer: diagnostics (can be null)
+// returns fault of the syntax (see. just_avail)
+method just_fault just_storage_build(just_storage* pstore, const char* source, int length, bool fixed, const just_tracer* tracer)
+{
+    if (fixed) {
+        just_stats eval = {};
+        // evaluation: presize storage from statistics
+        just_fault fault = just_avail(nullptr, &eval, source, length);
+        if (fault.code != JustParseCode::Ok)
+            return fault;
+        just_storage_reserve(pstore, eval);
+    }
+    // conclusion: build storage in one sweep
+    return just_avail(&pstore, nullptr, source, length, tracer);
+}
+
+method void just_object_parser::deserialize(const jstring& source) { deserialize(source.data(), source.size()); }
+
+method void just_object_parser::deserialize(const char* source, std::size_t len)
+{
+    just_parse_error error;
+
+    if (try_deserialize(source, len, &error) != JustParseCode::Ok)
+        throw error;
+}
+
+method JustParseCode just_object_parser::try_deserialize(const char* source, std::size_t len, just_parse_error* error)
+{
+    just_storage* pstorage;
+    just_tracer tracer;
+    just_fault fault;
+
+    if (len > INT_MAX) {
+        // large source: by chunks (see. begin), strings is copied, the reader is reported by exception
+        try {
+            begin();
+            for (std::size_t x = 0; x < len; x += Deserialize_Chunk)
+                feed(source + x, std::min<std::size_t>(len - x, Deserialize_Chunk));
+            finish();
+        } catch (const just_parse_error& e) {
+            if (error)
+                *error = e;
+            return e.code();
+        }
+        return JustParseCode::Ok;
+    }
+
+    prepare();
+    pstorage = static_cast<just_storage*>(_storage);
+
+    // source on mapped pages, strings can refer to
+    if (_mapping && source >= static_cast<const char*>(_mapping) && source + len <= static_cast<const char*>(_mapping) + _mappingLength)
+        just_storage_borrow(pstorage, source, len);
+
+    tracer = { &_diagnostics, _diagnosticLevel, source, nullptr };
+    try {
+        fault = just_storage_build(pstorage, source, static_cast<int>(len), _allocationMethod == JustAllocationMethod::fixed_allocation, _diagnostics ? &tracer : nullptr);
+        if (fault.code == JustParseCode::Ok)
+            complete();
+    } catch (...) {
+        just_storage_deinit(pstorage);
+        _storage = nullptr;
+        throw;
+    }
+
+    if (fault.code != JustParseCode::Ok) {
+        just_storage_deinit(pstorage);
+        _storage = nullptr;
+        // line and column (see. just_parse_error)
+        if (error)
+            *error = just_parse_error(fault.code, fault.position - source, fault.expected, source, len);
+    }
+    return fault.code;
+}
+
+method void just_object_parser::deserialize_lazy(const char* source, std::size_t len)
+{
+    just_storage* pstorage;
+    just_fault fault;
+
+    if (len > INT_MAX) {
+        // large source: is parsed fully (by chunks)
+        deserialize(source, len);
+        return;
+    }
+
+    prepare();
+    pstorage = static_cast<just_storage*>(_storage);
+    // pending trees refer to source
+    just_storage_borrow(pstorage, source, len);
+
+    try {
+        // lazy storage, trees of the root is pending (see. just_avail)
+        just_storage_grow(reinterpret_cast<void**>(&pstorage->lazy), &pstorage->lazyReserved, 1, sizeof(just_lazy_block), 64);
+        fault = just_avail(&pstorage, nullptr, source, static_cast<int>(len));
+        if (fault.code == JustParseCode::Ok)
+            complete();
+    } catch (...) {
+        just_storage_deinit(pstorage);
+        _storage = nullptr;
+        throw;
+    }
+
+    if (fault.code != JustParseCode::Ok) {
+        just_storage_deinit(pstorage);
+        _storage = nullptr;
+        throw just_parse_error(fault.code, fault.position - source, fault.expected, source, len);
+    }
+}
+
+method void just_object_parser::deserialize_parallel(const char* source, std::size_t len, unsigned threads)
+{
+    bool borrowed;
+    std::size_t x;
+    just_storage* pstorage;
+    std::vector<jnumber> bounds;
+    std::vector<just_storage*> shards;
+    std::vector<std::exception_ptr> errors;
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> next(0);
+    std::mutex lock;
+    const just_tracer tracer = { &_diagnostics, _diagnosticLevel, source, &lock };
+    const bool fixed = _allocationMethod == JustAllocationMethod::fixed_allocation;
+
+    if (!threads)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // pieces by top-level blocks, some per thread for balance
+    if (threads > 1)
+        just_split_blocks(source, static_cast<jnumber>(len), std::max<jnumber>(len / (threads * Parallel_Pieces), Parallel_MinPiece), bounds);
+    for (x = 1; x < bounds.size(); ++x)
+        if (bounds[x] - bounds[x - 1] > INT_MAX)
+            bounds.clear();
+    if (bounds.size() < 3) {
+        // one block or large block
+        deserialize(source, len);
+        return;
+    }
+
+    prepare();
+    pstorage = static_cast<just_storage*>(_storage);
+    borrowed = _mapping && source >= static_cast<const char*>(_mapping) && source + len <= static_cast<const char*>(_mapping) + _mappingLength;
+    if (borrowed)
+        just_storage_borrow(pstorage, source, len);
+
+    shards.resize(bounds.size() - 1, nullptr);
+    errors.resize(shards.size());
+
+    auto work = [&]() {
+        for (std::size_t y; (y = next++) < shards.size();) {
+            try {
+                shards[y] = just_storage_new_init();
+                // offsets of the borrowed strings from begin of the source
+                if (borrowed)
+                    just_storage_borrow(shards[y], source, len);
+                just_fault fault = just_storage_build(shards[y], source + bounds[y], static_cast<int>(bounds[y + 1] - bounds[y]), fixed, _diagnostics ? &tracer : nullptr);
+                if (fault.code != JustParseCode::Ok)
+                    errors[y] = std::make_exception_ptr(just_parse_error(fault.code, fault.position - source, fault.expected, source, len));
+            } catch (...) {
+                errors[y] = std::current_exception();
+            }
+        }
+    };
+    for (x = 1; x < threads && x < shards.size(); ++x) {
+        try {
+            workers.emplace_back(work);
+        } catch (const std::system_error&) {
+            // without more threads
+            break;
+        }
+    }
+    work();
+    for (std::thread& worker : workers)
+        worker.join();
+
+    try {
+        // first error by order of the source
+        for (const std::exception_ptr& error : errors)
+            if (error)
+                std::rethrow_exception(error);
+        just_storage_merge(pstorage, shards.data(), shards.size());
+        complete();
+    } catch (...) {
+        for (just_storage* shard : shards)
+            just_storage_deinit(shard);
+        just_storage_deinit(pstorage);
+        _storage = nullptr;
+        throw;
+    }
+    for (just_storage* shard : shards)
+        just_storage_deinit(shard);
+}
 
-            // prototype_node.set_native_memory(pointer);
-            // pointer = nullptr;
-            // prototype_node.flags = Node_ValueFlag | valueType << 2;
-        }
+method void just_object_parser::set_diagnostics(const just_diagnostics& sink, JustDiagnostic level)
+{
+    _diagnostics = level == JustDiagnostic::Off ? nullptr : sink;
+    _diagnosticLevel = level;
+}
+
+method void just_object_parser::prepare()
+{
+    if (_frozen)
+        throw std::logic_error("document is published, read only");
+    just_entry_free(entry, entryPages); // clears alls
+    entry = nullptr;
+    entryPages = 0;
+    delete static_cast<just_incremental*>(_incremental);
+    _incremental = nullptr;
+
+    // compiled paths (see. just_path) is resolved again
+    _generation = ++just_generations;
 
-        // entry.insert(std::make_pair(y = just_string_to_hash(prototype_node.propertyName.c_str()), prototype_node));
+    just_storage_deinit(static_cast<just_storage*>(_storage));
+
+    // init storage
+    _storage = just_storage_new_init();
+}
 
-        /*
-            #if defined(QDEBUG) || defined(DEBUG)
-                    // get iter
-                    auto _curIter = entry.find(j);
-                    if (_dbgLastNode) _dbgLastNode->nextNode = &_curIter->second;
-                    _curIter->second.prevNode = _dbgLastNode;
-                    _dbgLastNode = &_curIter->second;
-            #endif
-            */
-        x += just_autoskip_comment(pointer + x, length - x);
+method void just_object_parser::complete()
+{
+    just_storage* pstorage = static_cast<just_storage*>(_storage);
+
+    // freeze: compact regions for reading (lazy document is grown on access)
+    if (!pstorage->lazy)
+        just_storage_optimize(&pstorage);
+    // names index for lookup
+    just_storage_build_index(pstorage);
+    // node objects by node index (pages on demand, see. get_node)
+    entryPages = (pstorage->numNodes + Entry_PageSize - 1) >> Entry_PageShift;
+    entry = just_entry_grow(nullptr, 0, entryPages);
+
+    // storage is not refer to mapping, release it
+    if (_mapping && pstorage->source == nullptr) {
+        system_unmap_file(_mapping, _mappingLength);
+        _mapping = nullptr;
+        _mappingLength = 0;
     }
 }
 
-method void just_avail(just_storage** storage, just_stats& jstat, const char* source, int length)
+method void just_object_parser::freeze()
+{
+    just_storage* pstorage = static_cast<just_storage*>(_storage);
+    jnumber pages;
+
+    if (_incremental)
+        throw std::logic_error("incremental deserialization is not finished");
+    if (pstorage == nullptr)
+        return;
+
+    // lazy document: all trees is parsed, storage is not grown by readers
+    if (pstorage->lazy) {
+        just_storage_materialize_all(pstorage);
+        std::free(pstorage->lazy);
+        pstorage->lazy = nullptr;
+        pstorage->lazyReserved = 0;
+    }
+    // edit state is released: serialization of readers is not write to storage (see. just_serialize_edited)
+    std::free(pstorage->rows);
+    std::free(pstorage->owners);
+    std::free(pstorage->text);
+    pstorage->rows = nullptr;
+    pstorage->owners = nullptr;
+    pstorage->text = nullptr;
+    pstorage->rowsReserved = pstorage->ownersReserved = pstorage->textSize = 0;
+    just_storage_optimize(&pstorage);
+    // built before readers (see. search)
+    just_storage_build_search(pstorage);
+    // directory for all nodes, readers set pages only (see. get_node)
+    if ((pages = (pstorage->numNodes + Entry_PageSize - 1) >> Entry_PageShift) > entryPages) {
+        entry = just_entry_grow(entry, entryPages, pages);
+        entryPages = pages;
+    }
+    _frozen = true;
+}
+
+method void just_object_parser::begin()
 {
-    int x, z;
-    int depth; // depths
-    JustType valueType;
-    JustType current_block_type;
     just_storage* pstorage;
-    std::vector<jtree_t*> stack;
-    const char* pointer = source;
-    const char* epointer = source + length;
+    just_incremental* state;
 
-    // TODO: Linear load
+    prepare();
+    pstorage = static_cast<just_storage*>(_storage);
+    _incremental = state = new just_incremental();
 
-    pstorage = just_storage_new_init();
+    // root tree
+    state->stack.emplace_back(just_storage_alloc_tree(&pstorage), 0);
+}
 
-    stack.emplace_back(just_storage_alloc_tree(&pstorage));
+method void just_object_parser::feed(const char* chunk, std::size_t length)
+{
+    just_storage* pstorage = static_cast<just_storage*>(_storage);
+    just_incremental* state = static_cast<just_incremental*>(_incremental);
+
+    if (state == nullptr)
+        throw std::logic_error("deserialization is not began");
+
+    try {
+        state->reader.feed(chunk, length);
+        just_incremental_build(&pstorage, state);
+    } catch (...) {
+        delete state;
+        _incremental = nullptr;
+        just_storage_deinit(pstorage);
+        _storage = nullptr;
+        throw;
+    }
+}
 
-    for (depth = x = 0; pointer + x < epointer;) {
-        // has comment line
-        int y = x += just_autoskip_comment(pointer + x, length - x);
-        if (depth > 0 && pointer[x] == just_syntax.just_block_segments[1])
-            break;
-        x += just_skip(pointer + x, length - x);
+method void just_object_parser::finish()
+{
+    just_storage* pstorage = static_cast<just_storage*>(_storage);
+    just_incremental* state = static_cast<just_incremental*>(_incremental);
+
+    if (state == nullptr)
+        throw std::logic_error("deserialization is not began");
+
+    try {
+        state->reader.finish();
+        just_incremental_build(&pstorage, state);
+        just_storage_commit_tree(&pstorage, state->stack.back().first, state->nodes.data(), static_cast<int>(state->nodes.size()));
+        delete state;
+        _incremental = nullptr;
+        complete();
+    } catch (...) {
+        delete static_cast<just_incremental*>(_incremental);
+        _incremental = nullptr;
+        just_storage_deinit(pstorage);
+        _storage = nullptr;
+        throw;
+    }
+}
 
-        // Preparing, check property name
-        if (!just_valid_property_name(pointer + y, x - y))
-            throw std::bad_exception();
+// output of the serialization, buffer is flushed to stream (when is set)
+struct just_writer {
+    jstring buffer;
+    std::ostream* stream;
+    // characters before the buffer (written to stream)
+    jnumber flushed;
+    // written characters is kept in text (see. just_serialize_edited)
+    bool keep;
+    char* text;
+    jnumber textSize;
+    jnumber textReserved;
+};
 
-        // property name
-        // prototype_node.propertyName.append(just_source + y, static_cast<size_t>(x - y));
+// size of the buffer for flush to stream
+static const std::size_t Writer_Flush = 1 << 16;
+
+// Keep characters in text of the writer
+method void just_writer_keep(just_writer* writer, const char* chars, jnumber length)
+{
+    just_storage_grow(reinterpret_cast<void**>(&writer->text), &writer->textReserved, writer->textSize + length, sizeof(char), Writer_Flush);
+    std::memcpy(writer->text + writer->textSize, chars, length);
+    writer->textSize += length;
+}
 
-        std::cout << jstring(pointer + y, static_cast<size_t>(x - y)) << std::endl;
+method inline void just_writer_flush(just_writer* writer, bool force)
+{
+    if (writer->stream && (force || writer->buffer.size() >= Writer_Flush)) {
+        if (writer->keep)
+            just_writer_keep(writer, writer->buffer.data(), writer->buffer.size());
+        writer->stream->write(writer->buffer.data(), writer->buffer.size());
+        writer->flushed += writer->buffer.size();
+        writer->buffer.clear();
+    }
+}
 
-        //  has comment line
-        x += just_autoskip_comment(pointer + x, length - x);
-        // is block or array
-        if (pointer[x] == *just_syntax.just_block_segments) {
-            if (just_is_array(pointer + x, y, length - x)) {
-                y += x++;
-                current_block_type = JustType::Unknown;
-                // prototype_node.flags = Node_ArrayFlag;
-                for (; x < y;) {
-                    x += just_autoskip_comment(pointer + x, y - x);
-                    // next index
-                    if (pointer[x] == just_syntax.just_obstacle)
-                        ++x;
-                    else {
-                        x += z = just_get_format(pointer + x, nullptr, valueType);
-
-                        // Just Node Object current value Type
-
-                        if (valueType != JustType::Unknown) {
-                            if (current_block_type == JustType::Unknown) {
-                                current_block_type = valueType;
-                                switch (current_block_type) {
-                                case JustType::JustString:
-                                    ++jstat.jarrstrings;
-                                    break;
-                                case JustType::JustBoolean:
-                                    ++jstat.jarrbools;
-                                    break;
-                                case JustType::JustReal:
-                                    ++jstat.jarrreals;
-                                    break;
-                                case JustType::JustNumber:
-                                    ++jstat.jarrnumbers;
-                                    break;
-                                }
-                            }
-                            // convert just numbers as JustReal
-                            else if (false && current_block_type != valueType)
-                                throw std::runtime_error("Multi type is found.");
-
-                            switch (current_block_type) {
-                            case JustType::JustString:
-                                jstat.jarrstrings_total_bytes += z - 1;
-                                // prototype_node.set_native_memory((void*)jalloc<std::vector<jstring>>());
-                                break;
-                            case JustType::JustBoolean:
-                                jstat.jarrbools_total_bytes += z;
-                                // prototype_node.set_native_memory((void*)jalloc<std::vector<jbool>>());
-                                break;
-                            case JustType::JustReal:
-                                jstat.jarrreals_total_bytes += z;
-                                // prototype_node.set_native_memory((void*)jalloc<std::vector<jreal>>());
-                                break;
-                            case JustType::JustNumber:
-                                jstat.jarrnumbers_total_bytes += z;
-                                // prototype_node.set_native_memory((void*)jalloc<std::vector<jnumber>>());
-                                break;
-                            }
-                        }
-                    }
-                    x += just_autoskip_comment(pointer + x, y - x);
-                }
+// Position of the output (flushed and buffer)
+method inline jnumber just_writer_position(const just_writer* writer) { return writer->flushed + static_cast<jnumber>(writer->buffer.size()); }
 
-            } else { // enter the next node
-                // up next node
-                // x += just_avail_only(jstat, pointer + x, length - x);
+// Write characters of the output, large block is written to stream directly
+method void just_writer_copy(just_writer* writer, const char* chars, jnumber length)
+{
+    if (writer->stream && length >= static_cast<jnumber>(Writer_Flush)) {
+        just_writer_flush(writer, true);
+        if (writer->keep)
+            just_writer_keep(writer, chars, length);
+        writer->stream->write(chars, length);
+        writer->flushed += length;
+        return;
+    }
+    writer->buffer.append(chars, static_cast<std::size_t>(length));
+    just_writer_flush(writer, false);
+}
 
-                stack.emplace_back(just_storage_alloc_tree(&pstorage, stack.back())); // alloc tree on owner
-                ++x;
-                ++depth;
-                // x += just_autoskip_comment(pointer + x, length - x);
-            }
+// method for write number
+method void just_write_number(jstring& out, jnumber value)
+{
+    char local[24];
+    char* pointer = local + sizeof(local);
+    std::uint64_t digits = value < 0 ? 0 - static_cast<std::uint64_t>(value) : static_cast<std::uint64_t>(value);
+    do {
+        *--pointer = static_cast<char>('0' + digits % 10);
+        digits /= 10;
+    } while (digits);
+    if (value < 0)
+        *--pointer = '-';
+    out.append(pointer, local + sizeof(local) - pointer);
+}
 
-            if (false && pointer[x] != just_syntax.just_block_segments[1]) {
-                // Error: Line in require end depth
-                throw std::bad_exception();
-            }
-            ++x;
-        } else { // get also value
-            x += z = just_get_format(pointer + x, nullptr, valueType);
+// method for write real, shortest round-trip (see. just_scan_number)
+method void just_write_real(jstring& out, jreal value)
+{
+    char local[32];
+    int length, precision;
+    jnumber number;
+    jreal conv;
+    JustType type;
 
-            switch (valueType) {
-            case JustType::JustString:
-                ++jstat.jstrings;
-                jstat.jarrnumbers_total_bytes += z - 1;
-                break;
-            case JustType::JustBoolean:
-                ++jstat.jbools;
-                jstat.jarrbools_total_bytes += z;
-                break;
-            case JustType::JustReal:
-                ++jstat.jreals;
-                jstat.jarrreals_total_bytes += z;
-                break;
-            case JustType::JustNumber:
-                ++jstat.jnumbers;
-                jstat.jarrnumbers_total_bytes += z;
+    if (std::isnan(value))
+        throw std::domain_error("real is not a number");
+
+    if (std::isinf(value)) {
+        // overflow on read
+        out += value < 0 ? "-1e999" : "1e999";
+        return;
+    }
+
+    // fast path: short decimal, mantissa / 10^k is read exactly (see. just_scan_number)
+    if (std::fabs(value) < 1e15) {
+        for (precision = 0; precision <= 15; ++precision) {
+            jreal mantissa = std::round(std::fabs(value) * just_powers10[precision]);
+            if (mantissa >= 9007199254740992.0)
                 break;
+            if (mantissa / just_powers10[precision] == std::fabs(value)) {
+                char digits[24];
+                int count = 0;
+                std::uint64_t number = static_cast<std::uint64_t>(mantissa);
+                do {
+                    digits[count++] = static_cast<char>('0' + number % 10);
+                    number /= 10;
+                } while (number);
+                // digits is reversed: integer part, dot, fraction (precision digits)
+                length = 0;
+                if (std::signbit(value))
+                    local[length++] = '-';
+                if (count <= precision)
+                    local[length++] = '0';
+                for (int x = count - 1; x >= precision; --x)
+                    local[length++] = digits[x];
+                local[length++] = just_syntax.just_dot;
+                if (precision == 0)
+                    local[length++] = '0';
+                for (int x = precision - 1; x >= 0; --x)
+                    local[length++] = x < count ? digits[x] : '0';
+                out.append(local, length);
+                return;
             }
-
-            // prototype_node.set_native_memory(pointer);
-            // pointer = nullptr;
-            // prototype_node.flags = Node_ValueFlag | valueType << 2;
         }
+    }
 
-        // entry.insert(std::make_pair(y = just_string_to_hash(prototype_node.propertyName.c_str()), prototype_node));
-
-        /*
-            #if defined(QDEBUG) || defined(DEBUG)
-                    // get iter
-                    auto _curIter = entry.find(j);
-                    if (_dbgLastNode) _dbgLastNode->nextNode = &_curIter->second;
-                    _curIter->second.prevNode = _dbgLastNode;
-                    _dbgLastNode = &_curIter->second;
-            #endif
-            */
-        x += just_autoskip_comment(pointer + x, length - x);
+    for (precision = 15; precision <= 17; ++precision) {
+        length = just_dtoa_c(value, precision, local, sizeof(local) - 2);
+        // real has a dot or exponent
+        if (!std::strpbrk(local, ".eE")) {
+            local[length++] = just_syntax.just_dot;
+            local[length++] = '0';
+        }
+        if (precision == 17 || (just_scan_number(local, length, &type, &number, &conv) == length && type == JustType::JustReal && conv == value))
+            break;
     }
+    out.append(local, length);
 }
 
-// big algorithm, please free me.
-// divide and conquer method avail
-method int bug_just_avail(just_storage** storage, just_stats& eval, const char* source, int length, int depth)
+// method for write string in quotes with escape (control characters as \n, \r, \t), see. just_unescape
+method void just_write_string(jstring& out, const char* chars, int length)
 {
     int x, y;
-    const char* pointer;
-    JustType valueType;
-    JustType current_block_type;
+    const char* escape;
+    out += just_syntax.just_format_string;
+    for (x = 0, y = 0; x < length; ++x) {
+        if (chars[x] == just_syntax.just_format_string || chars[x] == just_syntax.just_left_seperator) {
+            out.append(chars + y, x - y);
+            out += just_syntax.just_left_seperator;
+            y = x;
+        } else if ((escape = static_cast<const char*>(std::memchr(just_syntax.just_escape_segments[1], chars[x], sizeof(just_syntax.just_escape_segments[1]))))) {
+            out.append(chars + y, x - y);
+            out += just_syntax.just_left_seperator;
+            out += just_syntax.just_escape_segments[0][escape - just_syntax.just_escape_segments[1]];
+            y = x + 1;
+        }
+    }
+    out.append(chars + y, x - y);
+    out += just_syntax.just_format_string;
+}
 
-    std::vector<jtree_t*> _stacks;
+// method for write value of the node (tree is not)
+method void just_write_value(jstring& out, const just_storage* pstore, int ipt)
+{
+    const void* pointer = just_storage_get_pointer(pstore, ipt);
+    switch (just_ipt_type(ipt)) {
+    case JustType::JustBoolean:
+        out += *static_cast<const jbool*>(pointer) ? just_syntax.just_true_string : just_syntax.just_false_string;
+        break;
+    case JustType::JustNumber:
+        just_write_number(out, *static_cast<const jnumber*>(pointer));
+        break;
+    case JustType::JustReal:
+        just_write_real(out, *static_cast<const jreal*>(pointer));
+        break;
+    case JustType::JustString: {
+        const just_string_t* str = static_cast<const just_string_t*>(pointer);
+        just_write_string(out, just_storage_get_chars(pstore, str), str->length);
+        break;
+    }
+    default:
+        out += just_syntax.just_null_string;
+        break;
+    }
+}
 
-    _stacks.emplace_back(just_storage_alloc_tree(storage)); // push head tree
+// method for write indent of the beautify format
+method inline void just_write_indent(jstring& out, std::size_t depth) { out.append(depth * 4, ' '); }
 
-#define prototype_node (_stacks.back()) // set a macro name
-#define push(object) (_stacks.push_back(object))
-#define pop() (_stacks.pop_back())
+// Serialize storage, trees by stack (without recursion)
+method void just_serialize(const just_storage* pstore, just_writer* writer, JustSerializeFormat format)
+{
+    just_locale_scope scope;
+    const bool beautify = format == JustSerializeFormat::JustBeautify;
+    jstring& out = writer->buffer;
+    const jtree_t* pjtree = static_cast<const jtree_t*>(just_storage_get_pointer(pstore, just_ipt_make(JustType::JustTree, 0)));
+    struct frame {
+        const jnode_t* next;
+        const jnode_t* first;
+        const jnode_t* end;
+    };
+    std::vector<frame> stack; // opened trees
+
+    if (beautify)
+        out += "//@Just Node Object Version: 1.0.0\n";
+
+    stack.push_back({ pstore->nodes + pjtree->offset, pstore->nodes + pjtree->offset, pstore->nodes + pjtree->offset + pjtree->length });
+    while (!stack.empty()) {
+        const jnode_t* pnode = stack.back().next;
+        const just_string_t* name;
+
+        // end of the tree
+        if (pnode == stack.back().end) {
+            stack.pop_back();
+            if (!stack.empty()) {
+                if (beautify)
+                    just_write_indent(out, stack.size() - 1);
+                out += just_syntax.just_block_segments[1];
+                if (beautify)
+                    out += just_syntax.just_eol_segment;
+            }
+            continue;
+        }
 
-    pointer = source;
+        // separator of the nodes
+        if (!beautify && pnode != stack.back().first)
+            out += just_syntax.just_obstacle;
+        ++stack.back().next;
+
+        if (beautify)
+            just_write_indent(out, stack.size() - 1);
+        name = static_cast<const just_string_t*>(just_storage_get_pointer(pstore, pnode->name));
+        out.append(just_storage_get_chars(pstore, name), name->length);
+
+        if (just_ipt_type(pnode->value) == JustType::JustTree) {
+            pjtree = static_cast<const jtree_t*>(just_storage_get_pointer(pstore, pnode->value));
+            if (beautify)
+                out += ' ';
+            out += just_syntax.just_block_segments[0];
+            if (pjtree->length == 0 || pstore->nodes[pjtree->offset].name == Invalid_IPT) {
+                // array in line
+                for (std::uint32_t x = 0; x < pjtree->length; ++x) {
+                    if (x)
+                        out += just_syntax.just_obstacle;
+                    if (beautify)
+                        out += ' ';
+                    just_write_value(out, pstore, pstore->nodes[pjtree->offset + x].value);
+                }
+                if (beautify && pjtree->length)
+                    out += ' ';
+                out += just_syntax.just_block_segments[1];
+            } else {
+                // enter the next node
+                if (beautify)
+                    out += just_syntax.just_eol_segment;
+                stack.push_back({ pstore->nodes + pjtree->offset, pstore->nodes + pjtree->offset, pstore->nodes + pjtree->offset + pjtree->length });
+                continue;
+            }
+        } else {
+            out += ' ';
+            just_write_value(out, pstore, pnode->value);
+        }
+        if (beautify)
+            out += just_syntax.just_eol_segment;
+        just_writer_flush(writer, false);
+    }
+    just_writer_flush(writer, true);
+}
 
-    for (x = 0; x < length;) {
-        // skip and trimming
-        y = x += just_autoskip_comment(pointer + x, length - x);
-        if (depth > 0 && pointer[x] == just_syntax.just_block_segments[1])
-            break;
-        x += just_skip(pointer + x, length - x);
+// Serialize edited document (compact, see. just_storage_thaw): clean trees is copied from the text of the last serialization,
+// edited trees (see. just_storage_touch) is written again. Text offset of a tree is relative to the parent, a copied tree keeps it.
+// Output is kept as text of the next serialization.
+method void just_serialize_edited(just_storage* pstore, just_writer* writer)
+{
+    just_locale_scope scope;
+    jstring& out = writer->buffer;
+    const char* text = pstore->text;
+    const jtree_t* pjtree = static_cast<const jtree_t*>(just_storage_get_pointer(pstore, just_ipt_make(JustType::JustTree, 0)));
+    struct frame {
+        const jnode_t* next;
+        const jnode_t* first;
+        const jnode_t* end;
+        int tree;
+        // begin of the content in output and in the last text
+        jnumber base;
+        jnumber textBase;
+    };
+    std::vector<frame> stack; // opened trees
+
+    writer->keep = true;
+    try {
+        if (text && !pstore->rows[0].dirty)
+            // document is not edited
+            just_writer_copy(writer, text, pstore->textSize);
+        else
+            stack.push_back({ pstore->nodes + pjtree->offset, pstore->nodes + pjtree->offset, pstore->nodes + pjtree->offset + pjtree->length, 0, 0, 0 });
+        while (!stack.empty()) {
+            const jnode_t* pnode = stack.back().next;
+            const just_string_t* name;
+            just_row* row;
+            jnumber begin;
+
+            // end of the tree
+            if (pnode == stack.back().end) {
+                row = pstore->rows + stack.back().tree;
+                begin = stack.back().base;
+                row->textLength = just_writer_position(writer) - begin;
+                row->dirty = 0;
+                stack.pop_back();
+                if (!stack.empty()) {
+                    row->textOffset = begin - stack.back().base;
+                    out += just_syntax.just_block_segments[1];
+                }
+                continue;
+            }
 
-        // Preparing, check property name
-        if (!just_valid_property_name(pointer + y, x - y))
-            throw std::bad_exception();
+            // separator of the nodes
+            if (pnode != stack.back().first)
+                out += just_syntax.just_obstacle;
+            ++stack.back().next;
 
-        // BUG: Set property name
-        // prototype_node.propertyName.append(pointer + y, static_cast<size_t>(x - y)); // set property name
+            name = static_cast<const just_string_t*>(just_storage_get_pointer(pstore, pnode->name));
+            out.append(just_storage_get_chars(pstore, name), name->length);
 
-        // has comment line
-        x += just_autoskip_comment(pointer + x, length - x);
-        x += just_trim(pointer + x, length - x); // trim string
-        // is block or array
-        if (pointer[x] == *just_syntax.just_block_segments) {
-            if (just_is_array(pointer + x, y, length - x)) {
-                y += x++;
-                current_block_type = JustType::Unknown;
-                // prototype_node.flags = Node_ArrayFlag;
-
-                // While end of array length
-                while (x < y) {
-                    x += just_autoskip_comment(pointer + x, y - x);
-                    // next index
-                    if (pointer[x] == just_syntax.just_obstacle)
-                        ++x;
-                    else {
-                        jvariant pvalue;
-                        x += just_get_format(pointer + x, storage, valueType, &pvalue);
-                        if (valueType != JustType::Unknown) {
-                            if (current_block_type == JustType::Unknown) {
-                                current_block_type = valueType;
-
-                                switch (current_block_type) {
-                                case JustType::JustBoolean:
-                                    // prototype_node.set_native_memory((void*)jalloc<std::vector<jbool>>());
-                                    break;
-                                case JustType::JustNumber:
-                                    // prototype_node.set_native_memory((void*)jalloc<std::vector<jnumber>>());
-                                    break;
-                                case JustType::JustReal:
-                                    // prototype_node.set_native_memory((void*)jalloc<std::vector<jreal>>());
-                                    break;
-                                case JustType::JustString:
-                                    // prototype_node.set_native_memory((void*)jalloc<std::vector<jstring>>());
-                                    break;
-                                }
-
-                            } else if (current_block_type != valueType && current_block_type == JustType::JustReal && valueType != JustType::JustNumber) {
-                                throw std::runtime_error("Multi type is found.");
-                            }
-
-                            switch (current_block_type) {
-                            case JustType::JustString: {
-                                /*auto ref = (jstring*)memory;
-                                    ((std::vector<jstring>*)prototype_node.handle)->emplace_back(*ref);
-                                    jfree(ref);*/
-                                break;
-                            }
-                            case JustType::JustBoolean: {
-                                //                                    auto ref = (jbool*)memory;
-                                //                                    ((std::vector<jbool>*)prototype_node.handle)->emplace_back(*ref);
-                                //                                    jfree(ref);
-                                break;
-                            }
-                            case JustType::JustReal: {
-                                //                                    jreal* ref;
-                                //                                    if (valueType == JustType::JustNumber) {
-                                //                                        ref = new jreal(static_cast<jreal>(*(jnumber*)memory));
-                                //                                        jfree((jnumber*)pointer);
-                                //                                    } else
-                                //                                        ref = (jreal*)memory;
-
-                                //                                    ((std::vector<jreal>*)prototype_node.handle)->emplace_back(*ref);
-                                //                                    jfree(ref);
-                                break;
-                            }
-                            case JustType::JustNumber: {
-                                //                                    auto ref = (jnumber*)memory;
-                                //                                    ((std::vector<jnumber>*)prototype_node.handle)->emplace_back(*ref);
-                                //                                    jfree(ref);
-                                break;
-                            }
-                            }
-                        }
-                    }
-                    x += just_autoskip_comment(pointer + x, y - x);
+            if (just_ipt_type(pnode->value) != JustType::JustTree) {
+                out += ' ';
+                just_write_value(out, pstore, pnode->value);
+                just_writer_flush(writer, false);
+                continue;
+            }
+
+            pjtree = static_cast<const jtree_t*>(just_storage_get_pointer(pstore, pnode->value));
+            row = pstore->rows + just_ipt_index(pnode->value);
+            out += just_syntax.just_block_segments[0];
+            begin = just_writer_position(writer);
+            if (!row->dirty) {
+                // clean tree: content of the last text
+                just_writer_copy(writer, text + stack.back().textBase + row->textOffset, row->textLength);
+            } else if (pjtree->length == 0 || pstore->nodes[pjtree->offset].name == Invalid_IPT) {
+                // array in line
+                for (std::uint32_t x = 0; x < pjtree->length; ++x) {
+                    if (x)
+                        out += just_syntax.just_obstacle;
+                    just_write_value(out, pstore, pstore->nodes[pjtree->offset + x].value);
                 }
+                row->textLength = just_writer_position(writer) - begin;
+                row->dirty = 0;
+            } else {
+                // enter the edited tree, clean subtrees is in the last text of it
+                stack.push_back({ pstore->nodes + pjtree->offset, pstore->nodes + pjtree->offset, pstore->nodes + pjtree->offset + pjtree->length, just_ipt_index(pnode->value), begin, stack.back().textBase + row->textOffset });
+                continue;
+            }
+            row->textOffset = begin - stack.back().base;
+            out += just_syntax.just_block_segments[1];
+            just_writer_flush(writer, false);
+        }
+        just_writer_flush(writer, true);
+    } catch (...) {
+        // offsets refer to the new text: all trees is written again
+        for (jnumber x = 0; x < pstore->numTrees; ++x)
+            pstore->rows[x].dirty = 1;
+        std::free(writer->text);
+        throw;
+    }
 
-                // BUG: Set node flags
-                // prototype_node.flags |= (current_block_type) << 2;
-            } else { // get the next node
-                auto _tree = just_storage_alloc_tree(storage);
+    // output without stream is in the buffer
+    if (!writer->stream)
+        just_writer_keep(writer, out.data(), out.size());
+    std::free(pstore->text);
+    pstore->text = writer->text;
+    pstore->textSize = writer->textSize;
+}
 
-                ++x;
-                x += bug_just_avail(storage, eval, pointer + x, length - x, depth + 1);
-                // prototype_node.flags = Node_StructFlag;
+method jstring just_object_parser::serialize(JustSerializeFormat format) const
+{
+    just_writer writer = {};
+    just_storage* pstore = static_cast<just_storage*>(_storage);
+    // lazy document: pending trees is parsed
+    just_storage_materialize_all(pstore);
+    if (pstore && pstore->rows && format == JustSerializeFormat::JustCompact)
+        just_serialize_edited(pstore, &writer);
+    else if (pstore)
+        just_serialize(pstore, &writer, format);
+    return writer.buffer;
+}
 
-                // BUG: set node memory pointer (handle)
-                //  prototype_node.set_native_memory(_nodes);
+method void just_object_parser::serialize(std::ostream& out, JustSerializeFormat format) const
+{
+    just_writer writer = {};
+    just_storage* pstore = static_cast<just_storage*>(_storage);
+    writer.stream = &out;
+    just_storage_materialize_all(pstore);
+    if (pstore && pstore->rows && format == JustSerializeFormat::JustCompact)
+        just_serialize_edited(pstore, &writer);
+    else if (pstore)
+        just_serialize(pstore, &writer, format);
+}
 
-                x += just_autoskip_comment(pointer + x, length - x);
-            }
-            if (pointer[x] != just_syntax.just_block_segments[1]) {
-                throw std::bad_exception();
-            }
-            ++x;
-        } else { // get also value
-            x += just_get_format(pointer + x, storage, valueType);
+// header of the binary image (.justb), regions follow it in a row (see. just_storage_align)
+struct just_binary_header {
+    char magic[4];
+    std::uint32_t version;
+    // Binary_Endian in byte order of the writer
+    std::uint32_t endian;
+    std::uint32_t headerSize;
+    // checksum of the regions (see. just_checksum)
+    std::uint64_t checksum;
+    std::uint64_t fileSize;
+    // vault order
+    std::uint64_t counts[5];
+    std::uint64_t numNodes;
+    std::uint64_t poolSize;
+    // slots of the names index
+    std::uint64_t indexSize;
+    // slots of the interned strings and references to them
+    std::uint64_t internCapacity;
+    std::uint64_t internHits;
+    // regions: bools, numbers, reals, strings, trees, nodes, pool, index tables, index slots, interned strings
+    std::uint64_t offsets[10];
+};
 
-            // BUG: prototype set memory pointer
-            // prototype_node.set_native_memory(memory);
+static const char Binary_Magic[4] = { 'J', 'U', 'S', 'B' };
+enum : std::uint32_t { Binary_Version = 2, Binary_Endian = 0x01020304 };
 
-            // BUG: memory ?
-            // memory = nullptr;
-            //  prototype_node.flags = Node_ValueFlag | valueType << 2;
-        }
+// method for checksum of the block (FNV-1a by words)
+method std::uint64_t just_checksum(const void* block, jnumber size, std::uint64_t hash = 14695981039346656037ULL)
+{
+    std::uint64_t word;
+    const char* pointer = static_cast<const char*>(block);
+    for (; size >= static_cast<jnumber>(sizeof(word)); size -= sizeof(word), pointer += sizeof(word)) {
+        std::memcpy(&word, pointer, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ULL;
+    }
+    for (; size > 0; --size)
+        hash = (hash ^ static_cast<std::uint8_t>(*pointer++)) * 1099511628211ULL;
+    return hash;
+}
 
-        // BUG: Insert node child
-        // entry.insert(std::make_pair(y = just_string_to_hash_fast(prototype_node.propertyName.c_str()), prototype_node));
+// Write binary image of the storage (optimized), borrowed strings is moved to pool
+method void just_storage_write_image(const just_storage* pstore, std::ostream& out)
+{
+    int x;
+    jnumber offset;
+    const void* regions[10];
+    jnumber sizes[10];
+    std::uint64_t checksum;
+    just_binary_header header = {};
+    std::vector<just_string_t> strings(pstore->numStrings);
+    std::vector<jnode_t> nodes;
+    jstring pool(pstore->pool ? pstore->pool : "", pstore->poolSize);
+    static const char padding[alignof(std::max_align_t)] = {};
+
+    // strings refer to pool only
+    for (jnumber y = 0; y < pstore->numStrings; ++y) {
+        strings[y] = static_cast<const just_string_t*>(pstore->vault[static_cast<int>(JustType::JustString) - 1])[y];
+        if (strings[y].flags & String_BorrowedFlag) {
+            const char* chars = pstore->source + strings[y].offset;
+            strings[y].offset = pool.size();
+            strings[y].flags = String_PoolFlag;
+            pool.append(chars, strings[y].length);
+            pool += '\0';
+        }
+    }
 
-        x += just_autoskip_comment(pointer + x, length - x);
+    // released rows of the mutable document: link to next row (see. just_storage_free_row) is not a name
+    if (pstore->rows) {
+        nodes.assign(pstore->nodes, pstore->nodes + pstore->numNodes);
+        for (x = 0; x < 32; ++x)
+            for (int row = pstore->freeRows[x]; row >= 0; row = pstore->nodes[row].name)
+                nodes[row].name = Invalid_IPT;
     }
 
-#undef prototype_node // undefine a macro name
-#undef push
-#undef pop
+    for (x = 0; x < 5; ++x) {
+        regions[x] = pstore->vault[x];
+        sizes[x] = (&pstore->numBools)[x] * just_type_size(static_cast<JustType>(x + 1));
+    }
+    regions[3] = strings.data();
+    regions[5] = pstore->rows ? nodes.data() : pstore->nodes;
+    sizes[5] = pstore->numNodes * sizeof(jnode_t);
+    regions[6] = pool.data();
+    sizes[6] = pool.size();
+    regions[7] = pstore->indexTables;
+    sizes[7] = pstore->numTrees * sizeof(jnumber);
+    regions[8] = pstore->index;
+    sizes[8] = pstore->indexSize * sizeof(just_index_slot);
+    regions[9] = pstore->intern;
+    sizes[9] = pstore->internCapacity * sizeof(just_index_slot);
+
+    std::memcpy(header.magic, Binary_Magic, sizeof(header.magic));
+    header.version = Binary_Version;
+    header.endian = Binary_Endian;
+    header.headerSize = sizeof(header);
+    for (x = 0; x < 5; ++x)
+        header.counts[x] = (&pstore->numBools)[x];
+    header.numNodes = pstore->numNodes;
+    header.poolSize = pool.size();
+    header.indexSize = pstore->indexSize;
+    header.internCapacity = pstore->internCapacity;
+    header.internHits = pstore->internHits;
+
+    checksum = 14695981039346656037ULL;
+    offset = just_storage_align(sizeof(header));
+    for (x = 0; x < 10; ++x) {
+        header.offsets[x] = offset;
+        offset += just_storage_align(sizes[x]);
+    }
+    header.fileSize = offset;
+
+    // regions with padding (checksum of the all after header)
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(padding, just_storage_align(sizeof(header)) - sizeof(header));
+    for (x = 0; x < 10; ++x) {
+        char last[sizeof(padding)] = {};
+        jnumber whole = sizes[x] & ~static_cast<jnumber>(sizeof(std::uint64_t) - 1);
+        jnumber tail = just_storage_align(sizes[x]) - whole;
+        if (!sizes[x])
+            continue;
+        out.write(static_cast<const char*>(regions[x]), sizes[x]);
+        out.write(padding, just_storage_align(sizes[x]) - sizes[x]);
+        // checksum by words as in the file: last word with padding
+        std::memcpy(last, static_cast<const char*>(regions[x]) + whole, sizes[x] - whole);
+        checksum = just_checksum(last, tail, just_checksum(regions[x], whole, checksum));
+    }
 
-    return x;
+    // complete header
+    header.checksum = checksum;
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!out)
+        throw std::runtime_error("error write file");
 }
 
-just_object_parser::just_object_parser()
-    : just_object_parser::just_object_parser(JustAllocationMethod::dynamic_allocation)
+// References of the image is in bounds: strings in pool, trees in nodes, nodes to values, index slots to nodes.
+// Trees from root is a tree (tree is referred once, root is not referred), lookups of the index is ended
+method void just_storage_check_image(const just_storage* pstore)
 {
+    jnumber x, y, capacity, empty;
+    int type;
+    const just_string_t* strings = static_cast<const just_string_t*>(pstore->vault[static_cast<int>(JustType::JustString) - 1]);
+    const jtree_t* trees = static_cast<const jtree_t*>(pstore->vault[static_cast<int>(JustType::JustTree) - 1]);
+    std::vector<std::uint8_t> referred(pstore->numTrees);
+
+    for (x = 0; x < pstore->numStrings; ++x)
+        if (strings[x].flags != String_PoolFlag || strings[x].offset > static_cast<std::uint64_t>(pstore->poolSize) || strings[x].length > pstore->poolSize - strings[x].offset)
+            throw std::runtime_error("binary image is invalid");
+
+    for (x = 0; x < pstore->numNodes; ++x) {
+        const jnode_t& node = pstore->nodes[x];
+        if (node.name != Invalid_IPT && (just_ipt_type(node.name) != JustType::JustString || just_ipt_index(node.name) >= pstore->numStrings))
+            throw std::runtime_error("binary image is invalid");
+        if (node.value == Invalid_IPT)
+            continue;
+        type = static_cast<int>(just_ipt_type(node.value));
+        if (type < static_cast<int>(JustType::JustBoolean) || type > static_cast<int>(JustType::JustTree) || just_ipt_index(node.value) >= (&pstore->numBools)[type - 1])
+            throw std::runtime_error("binary image is invalid");
+    }
+
+    for (x = 0; x < pstore->numTrees; ++x) {
+        if (static_cast<jnumber>(trees[x].offset) + trees[x].length > pstore->numNodes)
+            throw std::runtime_error("binary image is invalid");
+        if (pstore->indexTables[x] < 0)
+            continue;
+        capacity = just_index_capacity(trees[x].length);
+        if (pstore->indexTables[x] > pstore->indexSize - capacity)
+            throw std::runtime_error("binary image is invalid");
+        for (y = 0, empty = 0; y < capacity; ++y) {
+            const just_index_slot& slot = pstore->index[pstore->indexTables[x] + y];
+            if (slot.node == Index_Empty)
+                ++empty;
+            else if (slot.node >= pstore->numNodes)
+                throw std::runtime_error("binary image is invalid");
+        }
+        if (capacity && !empty)
+            throw std::runtime_error("binary image is invalid");
+    }
+
+    for (y = 0, empty = 0; y < pstore->internCapacity; ++y) {
+        if (pstore->intern[y].node == Index_Empty)
+            ++empty;
+        else if (pstore->intern[y].node >= pstore->numStrings)
+            throw std::runtime_error("binary image is invalid");
+    }
+    if (pstore->internCapacity && !empty)
+        throw std::runtime_error("binary image is invalid");
+
+    // trees from root, rows of the edited trees is left in nodes (is not reached)
+    referred[0] = 1;
+    for (std::vector<jnumber> stack(1, 0); !stack.empty();) {
+        const jtree_t& tree = trees[stack.back()];
+        stack.pop_back();
+        for (x = tree.offset; x < static_cast<jnumber>(tree.offset) + tree.length; ++x) {
+            if (just_ipt_type(pstore->nodes[x].value) != JustType::JustTree)
+                continue;
+            y = just_ipt_index(pstore->nodes[x].value);
+            if (referred[y])
+                throw std::runtime_error("binary image is invalid");
+            referred[y] = 1;
+            stack.push_back(y);
+        }
+    }
 }
 
-just_object_parser::just_object_parser(JustAllocationMethod allocationMethod)
-    : _storage(nullptr)
+// Storage refer to binary image (without copy), verify: checksum of the regions
+method void just_storage_image(just_storage* pstore, const void* image, jnumber length, bool verify)
 {
-    // TODO: param allocationMethod is support feature
+    int x;
+    just_binary_header header;
+    const char* base = static_cast<const char*>(image);
+    jnumber sizes[10];
+
+    if (length < static_cast<jnumber>(sizeof(header)))
+        throw std::runtime_error("binary image is invalid");
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, Binary_Magic, sizeof(header.magic)) || header.headerSize != sizeof(header) || header.endian != Binary_Endian)
+        throw std::runtime_error("binary image is invalid");
+    if (header.version != Binary_Version)
+        throw std::runtime_error("binary image version is not supported");
+    if (header.fileSize != static_cast<std::uint64_t>(length) || !header.counts[4])
+        throw std::runtime_error("binary image is invalid");
+    // counts is not greater than file (sizes is not overflowed), indexes is in IPT
+    for (x = 0; x < 5; ++x)
+        if (header.counts[x] > header.fileSize || header.counts[x] > static_cast<std::uint64_t>(IPT_IndexMask) + 1)
+            throw std::runtime_error("binary image is invalid");
+    if (header.numNodes > header.fileSize || header.numNodes > UINT32_MAX || header.poolSize > header.fileSize || header.indexSize > header.fileSize || header.internCapacity > header.fileSize)
+        throw std::runtime_error("binary image is invalid");
+
+    for (x = 0; x < 5; ++x)
+        sizes[x] = header.counts[x] * just_type_size(static_cast<JustType>(x + 1));
+    sizes[5] = header.numNodes * sizeof(jnode_t);
+    sizes[6] = header.poolSize;
+    sizes[7] = header.counts[4] * sizeof(jnumber);
+    sizes[8] = header.indexSize * sizeof(just_index_slot);
+    sizes[9] = header.internCapacity * sizeof(just_index_slot);
+    if (header.internCapacity & (header.internCapacity - 1))
+        throw std::runtime_error("binary image is invalid");
+    for (x = 0; x < 10; ++x)
+        if (header.offsets[x] % alignof(std::max_align_t) || header.offsets[x] > header.fileSize || static_cast<std::uint64_t>(sizes[x]) > header.fileSize - header.offsets[x])
+            throw std::runtime_error("binary image is invalid");
+
+    if (verify && just_checksum(base + header.offsets[0], header.fileSize - header.offsets[0]) != header.checksum)
+        throw std::runtime_error("binary image checksum mismatch");
+
+    for (x = 0; x < 5; ++x) {
+        pstore->vault[x] = const_cast<char*>(base + header.offsets[x]);
+        (&pstore->numBools)[x] = pstore->reserved[x] = header.counts[x];
+    }
+    pstore->nodes = reinterpret_cast<jnode_t*>(const_cast<char*>(base + header.offsets[5]));
+    pstore->numNodes = pstore->nodesReserved = header.numNodes;
+    pstore->pool = const_cast<char*>(base + header.offsets[6]);
+    pstore->poolSize = pstore->poolReserved = header.poolSize;
+    // names index is ready (see. just_storage_build_index)
+    pstore->indexTables = reinterpret_cast<jnumber*>(const_cast<char*>(base + header.offsets[7]));
+    pstore->index = reinterpret_cast<just_index_slot*>(const_cast<char*>(base + header.offsets[8]));
+    pstore->indexSize = header.indexSize;
+    // interned strings for lookup (see. just_storage_find_string)
+    pstore->intern = reinterpret_cast<just_index_slot*>(const_cast<char*>(base + header.offsets[9]));
+    pstore->internCapacity = header.internCapacity;
+    pstore->internHits = header.internHits;
+    // image is the source of the storage
+    just_storage_borrow(pstore, base, length);
+    pstore->external = true;
+    pstore->optimized = true;
+    just_storage_check_image(pstore);
 }
 
-just_object_parser::~just_object_parser() { }
-
-method void just_object_parser::deserialize_from(const jstring& filename)
+method void just_object_parser::serialize_binary(const jstring& filename) const
 {
-    long length;
-    char* buffer;
-    std::ifstream file;
+    std::ofstream file;
 
-    // try open file
-    file.open(filename);
+    if (_storage == nullptr)
+        throw std::runtime_error("document is empty");
 
-    // has error from open
+    just_storage_materialize_all(static_cast<just_storage*>(_storage));
+    file.open(filename, std::ios::binary | std::ios::trunc);
     if (!file)
         throw std::runtime_error("error open file");
+    just_storage_write_image(static_cast<const just_storage*>(_storage), file);
+}
 
-    // read length
-    length = file.seekg(0, std::ios::end).tellg();
-    file.seekg(0, std::ios::beg);
+method void just_object_parser::deserialize_binary(const jstring& filename, bool verify)
+{
+    jnumber mappingLength;
+    void* mapping;
+    void* lastMapping = _mapping;
+    jnumber lastMappingLength = _mappingLength;
+
+    if (_frozen)
+        throw std::logic_error("document is published, read only");
+    mapping = system_map_file(filename.c_str(), &mappingLength);
+
+    try {
+        prepare();
+        just_storage_image(static_cast<just_storage*>(_storage), mapping, mappingLength, verify);
+        _mapping = mapping;
+        _mappingLength = mappingLength;
+        complete();
+    } catch (...) {
+        just_storage_deinit(static_cast<just_storage*>(_storage));
+        _storage = nullptr;
+        // previous storage is released (see. prepare), unmap the previous file also
+        _mapping = nullptr;
+        _mappingLength = 0;
+        system_unmap_file(lastMapping, lastMappingLength);
+        system_unmap_file(mapping, mappingLength);
+        throw;
+    }
+    // previous storage is released, unmap the previous file
+    system_unmap_file(lastMapping, lastMappingLength);
+}
 
-    // check buffer
-    if ((buffer = (char*)malloc(length)) == nullptr)
+method just_object_node* just_object_parser::get_node(const void* handle)
+{
+    std::intptr_t index = static_cast<const jnode_t*>(handle) - static_cast<just_storage*>(_storage)->nodes;
+    jnumber page = index >> Entry_PageShift;
+    just_object_node* nodes;
+    just_object_node* expected = nullptr;
+
+    // pages for the new nodes (lazy document), published document has all pages (see. freeze)
+    if (page >= entryPages) {
+        jnumber pages = std::max(page + 1, entryPages * 2);
+        entry = just_entry_grow(entry, entryPages, pages);
+        entryPages = pages;
+    }
+    if ((nodes = entry[page].load(std::memory_order_acquire)))
+        return nodes + (index & (Entry_PageSize - 1));
+
+    // construct the page on first access, it is set once (other reader can set it first)
+    if (!(nodes = static_cast<just_object_node*>(std::malloc(Entry_PageSize * sizeof(just_object_node)))))
         throw std::bad_alloc();
+    for (jnumber x = 0; x < Entry_PageSize; ++x)
+        new (nodes + x) just_object_node(this, static_cast<std::uint32_t>((page << Entry_PageShift) + x));
+    if (!entry[page].compare_exchange_strong(expected, nodes, std::memory_order_acq_rel)) {
+        std::free(nodes);
+        nodes = expected;
+    }
+    return nodes + (index & (Entry_PageSize - 1));
+}
 
-    // read
-    length = file.readsome(buffer, length);
-    // close file
-    file.close();
+method just_object_node* just_object_parser::search(const jstring& pattern)
+{
+    int name;
+    std::uint64_t hash;
+    const jnode_t* pnode;
+    just_storage* pstore = static_cast<just_storage*>(_storage);
 
-    // deserialize
-    deserialize((char*)buffer, length);
-    // free buffer
-    free(buffer);
+    if (pstore == nullptr)
+        return nullptr;
+
+    // first by wide (from root), see. just_storage_build_search
+    just_storage_materialize_all(pstore);
+    just_storage_build_search(pstore);
+    if (pstore->searchIndex == nullptr)
+        return nullptr;
+    hash = just_string_hash(pattern.data(), static_cast<int>(pattern.size()));
+    if ((name = just_storage_find_string(pstore, pattern.data(), static_cast<int>(pattern.size()), hash)) == Invalid_IPT)
+        return nullptr;
+    pnode = just_index_find(pstore, pstore->searchIndex, pstore->searchCapacity, hash, name);
+    return pnode ? get_node(pnode) : nullptr;
 }
-method void just_object_parser::deserialize(const jstring& source) { deserialize(source.data(), source.size()); }
 
-method void just_object_parser::deserialize(const char* source, int len)
+method just_object_node* just_object_parser::tree(const jstring& nodename) { return at(nodename); }
+
+method just_object_node* just_object_parser::at(const jstring& nodePath)
 {
-    // FIXME: CLEAR FUNCTION IS UPGRADE
-    just_stats eval = {};
-    entry.clear(); // clears alls
+    const jnode_t* pnode = nullptr;
+    just_storage* pstore = static_cast<just_storage*>(_storage);
+    int tree;
+    std::size_t alpha = 0, beta;
 
-    if (_storage) {
-        std::free(_storage);
-    }
+    if (pstore == nullptr)
+        return nullptr;
 
-    // init storage
-    _storage = just_storage_new_init();
-    just_avail_only(eval, source, len);
+    tree = just_ipt_make(JustType::JustTree, 0);
+    // get splits
+    do {
+        if ((beta = nodePath.find(just_syntax.just_tree_pathbrk, alpha)) == jstring::npos)
+            beta = nodePath.length();
+        // lazy document: tree is parsed on first access
+        just_storage_materialize(pstore, tree);
+        if (!(pnode = just_storage_find_node(pstore, tree, nodePath.data() + alpha, static_cast<int>(beta - alpha))))
+            break;
+        // get the next section
+        tree = pnode->value;
+        alpha = beta + 1;
+    } while (beta < nodePath.length());
+    return pnode ? get_node(pnode) : nullptr;
 }
-method jstring just_object_parser::serialize(JustSerializeFormat format) const
+
+method just_path just_object_parser::compile(const jstring& nodePath) const { return just_path(nodePath); }
+
+method just_object_node* just_object_parser::at(const just_path& path)
 {
-    jstring data;
-    throw std::runtime_error("no complete");
+    const jnode_t* pnode = nullptr;
+    just_storage* pstore = static_cast<just_storage*>(_storage);
+    int tree;
+
+    // resolved for this document
+    if (path._generation == _generation)
+        return path._node < 0 ? nullptr : get_node(pstore->nodes + path._node);
+
+    path._generation = _generation;
+    path._node = -1;
+    if (pstore == nullptr)
+        return nullptr;
 
-    if (format == JustSerializeFormat::JustBeautify) {
-        data += "//@Just Node Object Version: 1.0.0\n";
+    tree = just_ipt_make(JustType::JustTree, 0);
+    for (const just_path::segment& segment : path._segments) {
+        just_storage_materialize(pstore, tree);
+        if (!(pnode = just_storage_find_node(pstore, tree, path._path.data() + segment.offset, segment.length, segment.hash)))
+            return nullptr;
+        // get the next section
+        tree = pnode->value;
     }
+    path._node = pnode - pstore->nodes;
+    return get_node(pnode);
+}
+
+just_path::just_path(const jstring& nodePath)
+    : _path(nodePath)
+    , _generation(-1)
+    , _node(-1)
+{
+    std::size_t alpha = 0, beta;
+    // get splits
+    do {
+        if ((beta = _path.find(just_syntax.just_tree_pathbrk, alpha)) == jstring::npos)
+            beta = _path.length();
+        _segments.push_back({ static_cast<std::uint32_t>(alpha), static_cast<std::uint32_t>(beta - alpha), just_string_hash(_path.data() + alpha, static_cast<int>(beta - alpha)) });
+        alpha = beta + 1;
+    } while (beta < _path.length());
+}
 
-    // jstruct* entry;
+method const jstring& just_path::path() const { return _path; }
 
-    // Write structure block
+method int just_object_parser::treeCount() const
+{
+    const just_storage* pstore = static_cast<const just_storage*>(_storage);
+    if (pstore == nullptr)
+        return 0;
+    return static_cast<const jtree_t*>(just_storage_get_pointer(pstore, just_ipt_make(JustType::JustTree, 0)))->length;
+}
 
-    // TODO: Go here write (serialize)
+method just_memory_usage just_object_parser::occupied_memory() const
+{
+    jnumber x;
+    just_memory_usage usage = {};
+    const just_storage* pstore = static_cast<const just_storage*>(_storage);
+
+    if (pstore == nullptr)
+        return usage;
+
+    just_storage_usage(pstore, &usage);
+
+    // node objects is created on demand by pages (see. get_node)
+    usage.objects.reserved = system_block_size(entry, entryPages * sizeof(std::atomic<just_object_node*>));
+    usage.objects.live = entryPages * sizeof(std::atomic<just_object_node*>);
+    for (x = 0; x < entryPages; ++x) {
+        just_object_node* nodes = entry[x].load(std::memory_order_acquire);
+        if (!nodes)
+            continue;
+        usage.objects.live += Entry_PageSize * sizeof(just_object_node);
+        usage.objects.reserved += system_block_size(nodes, Entry_PageSize * sizeof(just_object_node));
+    }
+    usage.total.live += usage.objects.live;
+    usage.total.reserved += usage.objects.reserved;
 
-    return data;
+    usage.mapped = _mappingLength;
+    return usage;
 }
-method just_object_node* just_object_parser::search(const jstring& pattern)
+
+method jbool just_object_parser::contains(const jstring& nodePath) { return at(nodePath) != nullptr; }
+
+method void* just_object_parser::edit()
 {
-    just_object_node* node;
-    int hash = just_string_to_hash_fast(pattern.c_str());
+    if (_frozen)
+        throw std::logic_error("document is published, read only");
+    if (_incremental)
+        throw std::logic_error("incremental deserialization is not finished");
+    // new document (root is empty)
+    if (_storage == nullptr)
+        deserialize(nullptr, 0);
+    just_storage_thaw(static_cast<just_storage*>(_storage));
+    return _storage;
+}
 
-    auto iter = this->entry.find(hash);
+method void just_object_parser::changed() { _generation = ++just_generations; }
 
-    if (iter != std::end(this->entry))
-        node = &iter->second;
+method just_object_node* just_object_parser::insert_node(int tree, const jstring* name, const just_value& value)
+{
+    just_storage* pstore = static_cast<just_storage*>(edit());
+    const jtree_t* pjtree;
+    int nameIpt = Invalid_IPT, valueIpt;
+
+    if (just_ipt_type(tree) != JustType::JustTree)
+        throw std::bad_cast();
+    just_storage_materialize(pstore, tree);
+    pjtree = static_cast<const jtree_t*>(just_storage_get_pointer(pstore, tree));
+
+    // tree of properties or array (elements without names), empty tree is both
+    if (pjtree->length && (pstore->nodes[pjtree->offset].name == Invalid_IPT) != (name == nullptr))
+        throw std::invalid_argument(name ? "tree is array" : "tree is not array");
+    if (name) {
+        if (!just_valid_property_name(name->data(), static_cast<int>(name->size())))
+            throw std::invalid_argument("invalid property name");
+        std::memcpy(just_storage_alloc_field(&pstore, JustType::JustString, static_cast<int>(name->size())), name->data(), name->size());
+        nameIpt = just_storage_intern(pstore);
+        valueIpt = just_storage_alloc_value(pstore, value._type, value.data(), value._length);
+    } else if (value._type == JustType::JustTree)
+        throw std::invalid_argument("element of the array is value");
+    else if (value._type == JustType::JustString)
+        valueIpt = just_storage_alloc_value(pstore, value._type, value.data(), value._length);
     else
-        node = nullptr;
-    return node;
+        std::memcpy(just_storage_get_pointer(pstore, valueIpt = just_storage_alloc_element(pstore, tree, value._type)), value.data(), just_type_size(value._type));
+
+    jnumber node = just_storage_add_node(pstore, tree, nameIpt, valueIpt);
+    changed();
+    return get_node(pstore->nodes + node);
 }
 
-method just_object_node* just_object_parser::tree(const jstring& nodename) { return at(nodename); }
+method jbool just_object_parser::remove_node(int tree, const jstring& name)
+{
+    just_storage* pstore = static_cast<just_storage*>(edit());
+    const jnode_t* pnode;
+
+    if (just_ipt_type(tree) != JustType::JustTree)
+        throw std::bad_cast();
+    just_storage_materialize(pstore, tree);
+    if (!(pnode = just_storage_find_node(pstore, tree, name.data(), static_cast<int>(name.size()))))
+        return false;
+    just_storage_remove_node(pstore, tree, static_cast<std::uint32_t>(pnode - pstore->nodes));
+    changed();
+    return true;
+}
 
-method just_object_node* just_object_parser::at(const jstring& nodePath)
+method just_object_node* just_object_parser::add_child(const jstring& name, const just_value& value) { return insert_node(just_ipt_make(JustType::JustTree, 0), &name, value); }
+
+method jbool just_object_parser::remove_child(const jstring& name) { return remove_node(just_ipt_make(JustType::JustTree, 0), name); }
+
+method std::shared_ptr<just_object_parser> just_document::snapshot() const { return std::atomic_load(&_current); }
+
+method void just_document::publish(std::unique_ptr<just_object_parser> document)
 {
-    just_object_node* node = nullptr;
-    std::add_pointer<decltype(this->entry)>::type entry = &this->entry;
-    decltype(entry->begin()) iter;
-    int alpha = 0, beta;
-    int hash;
-    // get splits
-    do {
-        if ((beta = nodePath.find(just_syntax.just_tree_pathbrk, alpha)) == ~0)
-            beta = static_cast<int>(nodePath.length());
-        hash = just_string_to_hash_fast(nodePath.c_str() + alpha, beta - alpha);
-        iter = entry->find(hash);
-        if (iter != end(*entry)) {
-            if (iter->second.has_tree())
-                entry = nullptr; // decltype(entry)(iter->second._bits);
-            else {
-                if (beta == nodePath.length())
-                    node = &iter->second; // get the next section
-                break;
-            }
-        }
-        alpha = ++beta;
-        beta = nodePath.length();
+    std::shared_ptr<just_object_parser> snapshot;
 
-    } while (alpha < beta);
-    return node;
+    if (document) {
+        document->freeze();
+        snapshot.reset(document.release());
+    }
+    // readers of the previous snapshot keep it, released by the last
+    std::atomic_store(&_current, snapshot);
 }
 
-method jbool just_object_parser::contains(const jstring& nodePath) { return at(nodePath) != nullptr; }
+method void just_document::reload(const jstring& filename, JustLoadMethod loadMethod, unsigned threads)
+{
+    std::unique_ptr<just_object_parser> document(new just_object_parser());
+    // current snapshot is kept on error
+    document->deserialize_from(filename, loadMethod, threads);
+    publish(std::move(document));
+}
 
 method just_object_node& operator<<(just_object_node& root, const jstring& nodename) { return *root.tree(nodename); }
 
@@ -1312,19 +4582,23 @@ method just_object_node& operator<<(just_object_parser& root, const jstring& nod
 
 method std::ostream& operator<<(std::ostream& out, const just_object_node& node)
 {
-    switch (node.type()) {
+    JustType type;
+    const void* value = node.get_value(&type);
+    switch (type) {
     case JustType::JustNumber:
-        out << static_cast<jnumber>(node);
+        out << *static_cast<const jnumber*>(value);
         break;
     case JustType::JustBoolean:
-        out << static_cast<jbool>(node);
+        out << *static_cast<const jbool*>(value);
         break;
     case JustType::JustReal:
-        out << static_cast<jreal>(node);
+        out << *static_cast<const jreal*>(value);
         break;
-    case JustType::JustString:
-        out << static_cast<jstring>(node);
+    case JustType::JustString: {
+        const just_string_t* str = static_cast<const just_string_t*>(value);
+        out.write(just_storage_get_chars(static_cast<const just_storage*>(node._jowner->_storage), str), str->length);
         break;
+    }
     case JustType::Unknown:
         out << just_syntax.just_unknown_string;
         break;
@@ -1338,17 +4612,55 @@ method std::ostream& operator<<(std::ostream& out, const just_object_node& node)
 
 method std::ostream& operator<<(std::ostream& out, const just_object_parser& parser)
 {
-    if (false)
-        out << just_syntax.just_unknown_string;
-    else
-        out << parser.serialize();
+    parser.serialize(out);
     return out;
 }
 
-const jnumber just_object_node::get_int() const { return *static_cast<jnumber*>(_jhead); }
-const jbool just_object_node::get_bool() const { return *static_cast<jbool*>(_jhead); }
-const jstring just_object_node::get_str() const { return jstring(static_cast<char*>(_jhead)); }
-const jreal just_object_node::get_real() const { return *static_cast<jreal*>(_jhead); }
+const void* just_object_node::get_value(JustType* type) const
+{
+    const just_storage* pstore = static_cast<const just_storage*>(_jowner->_storage);
+    int ipt = just_storage_node(pstore, _jhead)->value;
+    *type = just_ipt_type(ipt);
+    return *type < JustType::JustBoolean ? nullptr : just_storage_get_field(pstore, *type, ipt);
+}
+const jnumber just_object_node::get_int() const
+{
+    JustType type;
+    const void* pointer = get_value(&type);
+    switch (type) {
+    case JustType::JustNumber:
+        return *static_cast<const jnumber*>(pointer);
+    case JustType::JustReal:
+        return static_cast<jnumber>(*static_cast<const jreal*>(pointer));
+    case JustType::JustBoolean:
+        return *static_cast<const jbool*>(pointer);
+    }
+    throw std::bad_cast();
+}
+const jbool just_object_node::get_bool() const
+{
+    JustType type;
+    const void* pointer = get_value(&type);
+    if (type == JustType::JustBoolean)
+        return *static_cast<const jbool*>(pointer);
+    return get_int() != 0;
+}
+const jstring just_object_node::get_str() const
+{
+    JustType type;
+    const just_string_t* str = static_cast<const just_string_t*>(get_value(&type));
+    if (type != JustType::JustString)
+        throw std::bad_cast();
+    return jstring(just_storage_get_chars(static_cast<const just_storage*>(_jowner->_storage), str), str->length);
+}
+const jreal just_object_node::get_real() const
+{
+    JustType type;
+    const void* pointer = get_value(&type);
+    if (type == JustType::JustReal)
+        return *static_cast<const jreal*>(pointer);
+    return static_cast<jreal>(get_int());
+}
 } // namespace just
 
 #undef method